@@ -37,6 +37,7 @@ struct ParseRequest {
     std::optional<std::string> errormsg;
     bool needsparsing = true;
     srcml_transform_result* results = nullptr;
+    std::vector<srcml_transform_result*> bundle_results;
     std::shared_ptr<srcml_archive> input_archive;
     bool exists = true;
 };
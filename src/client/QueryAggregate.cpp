@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file QueryAggregate.cpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ */
+
+#include <QueryAggregate.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace ::std::literals::string_view_literals;
+
+std::string QueryAggregate::mode;
+std::vector<QueryAggregate::Partial> QueryAggregate::partials;
+
+namespace {
+
+    // number as text, with no fraction for whole numbers
+    std::string number_string(double number) {
+
+        if (std::isnan(number))
+            return "NaN";
+
+        if (number == std::floor(number) && std::fabs(number) < 1e15)
+            return std::to_string((long long) number);
+
+        return std::to_string(number);
+    }
+
+    // number from text, or NaN when the text is not a number
+    double string_number(const std::string& s) {
+
+        char* end = nullptr;
+        double number = std::strtod(s.data(), &end);
+        if (s.empty() || end != s.data() + s.size())
+            return std::nan("");
+
+        return number;
+    }
+}
+
+bool QueryAggregate::valid(std::string_view mode) {
+
+    return mode == "sum"sv || mode == "count"sv || mode == "min"sv || mode == "max"sv ||
+           mode == "any"sv || mode == "all"sv || mode == "histogram"sv;
+}
+
+void QueryAggregate::init(std::string_view mode, int threads) {
+
+    QueryAggregate::mode = mode;
+    partials.assign((std::size_t) std::max(threads, 1), Partial());
+}
+
+bool QueryAggregate::add(int thread_id, srcml_transform_result* result) {
+
+    // value, truth, and text of the result using XPath conversions
+    double number = 0;
+    bool truth = false;
+    std::string text;
+    switch (srcml_transform_get_type(result)) {
+    case SRCML_RESULT_NUMBER:
+        number = srcml_transform_get_number(result);
+        truth = number != 0 && !std::isnan(number);
+        text = number_string(number);
+        break;
+
+    case SRCML_RESULT_BOOLEAN:
+        truth = srcml_transform_get_bool(result) == 1;
+        number = truth ? 1 : 0;
+        text = truth ? "true" : "false";
+        break;
+
+    case SRCML_RESULT_STRING:
+        text = srcml_transform_get_string(result) ? srcml_transform_get_string(result) : "";
+        number = string_number(text);
+        truth = !text.empty();
+        break;
+
+    default:
+        return false;
+    };
+
+    // only the worker thread uses its partial result
+    auto& partial = partials[(std::size_t) thread_id];
+    ++partial.count;
+    partial.any = partial.any || truth;
+    partial.all = partial.all && truth;
+    if (!std::isnan(number)) {
+        partial.min = partial.numbers ? std::min(partial.min, number) : number;
+        partial.max = partial.numbers ? std::max(partial.max, number) : number;
+        partial.sum += number;
+        ++partial.numbers;
+    }
+    if (mode == "histogram"sv)
+        ++partial.histogram[text];
+
+    return true;
+}
+
+void QueryAggregate::report(srcml_archive* archive) {
+
+    Partial total;
+    for (const auto& partial : partials) {
+        if (partial.numbers) {
+            total.min = total.numbers ? std::min(total.min, partial.min) : partial.min;
+            total.max = total.numbers ? std::max(total.max, partial.max) : partial.max;
+        }
+        total.count   += partial.count;
+        total.numbers += partial.numbers;
+        total.sum     += partial.sum;
+        total.any      = total.any || partial.any;
+        total.all      = total.all && partial.all;
+        for (const auto& entry : partial.histogram)
+            total.histogram[entry.first] += entry.second;
+    }
+
+    std::string answer;
+    if (mode == "sum"sv) {
+        answer = number_string(total.sum) + '\n';
+    } else if (mode == "count"sv) {
+        answer = std::to_string(total.count) + '\n';
+    } else if (mode == "min"sv) {
+        answer = number_string(total.numbers ? total.min : std::nan("")) + '\n';
+    } else if (mode == "max"sv) {
+        answer = number_string(total.numbers ? total.max : std::nan("")) + '\n';
+    } else if (mode == "any"sv) {
+        answer = total.any ? "true\n" : "false\n";
+    } else if (mode == "all"sv) {
+        answer = total.all ? "true\n" : "false\n";
+    } else if (mode == "histogram"sv) {
+
+        // numbers in numeric order, before other text
+        std::vector<std::pair<std::string, long>> entries(total.histogram.begin(), total.histogram.end());
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            double na = string_number(a.first);
+            double nb = string_number(b.first);
+            if (std::isnan(na) || std::isnan(nb))
+                return !std::isnan(na) && std::isnan(nb);
+            return na < nb;
+        });
+
+        for (const auto& entry : entries) {
+            answer += entry.first;
+            answer += '\t';
+            answer += std::to_string(entry.second);
+            answer += '\n';
+        }
+    }
+
+    srcml_archive_write_string(archive, answer.data(), (int) answer.size());
+}
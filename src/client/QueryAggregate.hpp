@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file QueryAggregate.hpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * Reduction of the scalar query results of all units into a single answer
+ */
+
+#ifndef INCLUDED_QUERYAGGREGATE_HPP
+#define INCLUDED_QUERYAGGREGATE_HPP
+
+#include <srcml.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class QueryAggregate {
+public:
+
+    // aggregation modes for --aggregate
+    static bool valid(std::string_view mode);
+
+    // mode and number of worker threads, each with its own partial result
+    static void init(std::string_view mode, int threads);
+
+    // reduce a scalar result into the partial result of the worker thread
+    static bool add(int thread_id, srcml_transform_result* result);
+
+    // merge the partial results, and write the answer
+    static void report(srcml_archive* archive);
+
+private:
+
+    // partial result of a worker thread, on its own cache line
+    struct alignas(64) Partial {
+        long count = 0;
+        long numbers = 0;
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        bool any = false;
+        bool all = true;
+        std::map<std::string, long> histogram;
+    };
+
+    static std::string mode;
+    static std::vector<Partial> partials;
+};
+
+#endif
@@ -237,8 +237,13 @@ void create_src(const srcml_request_t& srcml_request,
 
             auto arch(srcml_read_open_internal(input_source, srcml_request.revision));
 
+            // read the requested unit directly when the input supports random access
+            std::unique_ptr<srcml_unit> first_unit;
+            if (srcml_request.unit > 0)
+                first_unit.reset(srcml_archive_read_unit_at(arch.get(), (size_t) srcml_request.unit));
+
             // move to the correct unit
-            for (int i = 1; i < srcml_request.unit; ++i) {
+            for (int i = 1; !first_unit && i < srcml_request.unit; ++i) {
                 if (!srcml_archive_skip_unit(arch.get())) {
                     SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
                     exit(1);
@@ -246,7 +251,7 @@ void create_src(const srcml_request_t& srcml_request,
             }
 
             while (1) {
-                std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(arch.get()));
+                std::unique_ptr<srcml_unit> unit(first_unit ? first_unit.release() : srcml_archive_read_unit(arch.get()));
                 if (srcml_request.unit && !unit) {
                     SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
                     exit(1);
@@ -329,15 +334,21 @@ void create_src(const srcml_request_t& srcml_request,
 
         auto arch(srcml_read_open_internal(input_sources[0], srcml_request.revision));
 
+        // read the requested unit directly when the input supports random access
+        std::unique_ptr<srcml_unit> unit;
+        if (srcml_request.unit > 0)
+            unit.reset(srcml_archive_read_unit_at(arch.get(), (size_t) srcml_request.unit));
+
         // move to the correct unit
-        for (int i = 1; i < srcml_request.unit; ++i) {
+        for (int i = 1; !unit && i < srcml_request.unit; ++i) {
             if (!srcml_archive_skip_unit(arch.get())) {
                 SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
                 exit(1);
             }
         }
 
-        std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(arch.get()));
+        if (!unit)
+            unit.reset(srcml_archive_read_unit(arch.get()));
         if (!unit) {
             SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
             exit(1);
@@ -26,6 +26,7 @@
 #include <input_archive.hpp>
 #include <SRCMLStatus.hpp>
 #include <ParserTest.hpp>
+#include <QueryAggregate.hpp>
 #include <libarchive_utilities.hpp>
 #include <string_view>
 
@@ -254,6 +255,12 @@ void create_srcml(const srcml_request_t& srcml_request,
         }
     }
 
+    // conversions of srcQL queries to XPath are cached across runs
+    if (srcml_request.srcql_cache && srcml_set_srcql_cache(srcml_request.srcql_cache->data()) != SRCML_STATUS_OK) {
+        SRCMLstatus(ERROR_MSG, "srcml: '%s' is not a srcQL cache", *srcml_request.srcql_cache);
+        exit(SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
     // iterate through all transformations added during cli parsing
     std::size_t xpath_index = 0;
     for (const auto& trans : srcml_request.transformations) {
@@ -317,6 +324,10 @@ void create_srcml(const srcml_request_t& srcml_request,
     // write queue for output of parsing
     WriteQueue write_queue(log, destination);
 
+    // partial results of the parsing threads for aggregation
+    if (srcml_request.aggregate)
+        QueryAggregate::init(*srcml_request.aggregate, srcml_request.max_threads);
+
     // parsing queue
     ParseQueue parse_queue(srcml_request.max_threads, &write_queue);
 
@@ -355,6 +366,10 @@ void create_srcml(const srcml_request_t& srcml_request,
         ParserTest::report(srcml_arch.get());
     }
 
+    if (srcml_request.aggregate) {
+        QueryAggregate::report(srcml_arch.get());
+    }
+
     if (status != -1 || always_archive) {
         srcml_archive_close(srcml_arch.get());
     }
@@ -11,6 +11,7 @@
 #include <src_prefix.hpp>
 #include <SRCMLStatus.hpp>
 #include <CPUCount.hpp>
+#include <QueryAggregate.hpp>
 #include <algorithm>
 #include <CLI11.hpp>
 #include <string_view>
@@ -475,6 +476,14 @@ srcml_request_t parseCLI11(int argc, char* argv[]) {
         "Output number of srcML files and exit")
         ->group("METADATA OPTIONS");
 
+    app.add_flag_callback("--index",          [&]() { srcml_request.command |= SRCML_COMMAND_INDEX; },
+        "Write a unit index, FILE.idx, for random access to the units of the srcML file and exit")
+        ->group("METADATA OPTIONS");
+
+    app.add_flag_callback("--term-index",     [&]() { srcml_request.command |= SRCML_COMMAND_TERM_INDEX; },
+        "Write a term index, FILE.tidx, so queries skip the units of the srcML file that cannot match and exit")
+        ->group("METADATA OPTIONS");
+
     app.add_option("--show-prefix", srcml_request.xmlns_prefix_query,
         "Output prefix of namespace URI and exit")
         ->type_name("URI")
@@ -584,6 +593,29 @@ srcml_request_t parseCLI11(int argc, char* argv[]) {
             });
     }
 
+    app.add_flag_callback("--query-bundle", [&]() { srcml_request.command |= SRCML_COMMAND_QUERY_BUNDLE; },
+        "Apply each XPATH and SRCQL query independently to the same unit, tagging each result with the query number")
+        ->group("QUERY & TRANSFORMATION");
+
+    app.add_option("--aggregate", srcml_request.aggregate,
+        "Reduce the scalar query results of all units to one answer with MODE: sum, count, min, max, any, all, or histogram")
+        ->type_name("MODE")
+        ->group("QUERY & TRANSFORMATION")
+        ->check([&](const std::string &value)->std::string {
+
+            if (!QueryAggregate::valid(value)) {
+                return std::string("invalid aggregate mode \"") + value + "\"";
+            }
+
+            return "";
+        })
+        ->each([&](std::string) { srcml_request.command |= SRCML_COMMAND_AGGREGATE; });
+
+    app.add_option("--srcql-cache", srcml_request.srcql_cache,
+        "Cache the conversions of SRCQL queries in FILE, and reuse them in later runs")
+        ->type_name("FILE")
+        ->group("QUERY & TRANSFORMATION");
+
     app.add_flag_callback("--srcql-warning-off,-F", [&]() { srcml_request.command |= SRCML_COMMAND_SRCQL_WARNING_OFF; },
         "Turn off warning for srcql queries that have no logical variables")
         ->group("QUERY & TRANSFORMATION");
@@ -815,6 +847,12 @@ srcml_request_t parseCLI11(int argc, char* argv[]) {
         exit(CLI_STATUS_ERROR);
     }
 
+    // each query of a --query-bundle is output separately, so there is nothing to aggregate
+    if ((srcml_request.command & SRCML_COMMAND_QUERY_BUNDLE) && (srcml_request.command & SRCML_COMMAND_AGGREGATE)) {
+        SRCMLstatus(ERROR_MSG, "srcml: --aggregate cannot be used with --query-bundle");
+        exit(CLI_STATUS_ERROR);
+    }
+
     if (srcml_request.output_filename.protocol.empty())
         srcml_request.output_filename = "stdout://-";
 
@@ -75,6 +75,14 @@ const unsigned long long SRCML_COMMAND_SRCQL_WARNING_OFF         = 1ull << 32ull
 
 const unsigned long long SRCML_COMMAND_HEADER                    = 1ull << 33ull;
 
+const unsigned long long SRCML_COMMAND_INDEX                     = 1ull << 34ull;
+
+const unsigned long long SRCML_COMMAND_QUERY_BUNDLE              = 1ull << 35ull;
+
+const unsigned long long SRCML_COMMAND_AGGREGATE                 = 1ull << 36ull;
+
+const unsigned long long SRCML_COMMAND_TERM_INDEX                = 1ull << 37ull;
+
 // commands that are simple queries on srcml
 const unsigned long long SRCML_COMMAND_INSRCML =
     SRCML_COMMAND_LONGINFO |
@@ -89,7 +97,9 @@ const unsigned long long SRCML_COMMAND_INSRCML =
     SRCML_COMMAND_DISPLAY_SRCML_SRC_VERSION |
     SRCML_COMMAND_DISPLAY_SRCML_ENCODING |
     SRCML_COMMAND_DISPLAY_SRCML_TIMESTAMP |
-    SRCML_COMMAND_DISPLAY_SRCML_HASH;
+    SRCML_COMMAND_DISPLAY_SRCML_HASH |
+    SRCML_COMMAND_INDEX |
+    SRCML_COMMAND_TERM_INDEX;
 
 // Error Codes
 const int CLI_STATUS_OK = 0;
@@ -159,6 +169,12 @@ struct srcml_request_t {
 
     std::optional<size_t> revision;
 
+    // reduction of scalar query results
+    std::optional<std::string> aggregate;
+
+    // persistent cache of srcQL conversions
+    std::optional<std::string> srcql_cache;
+
     // pre-input
     char buf[4] = { 0 };
     size_t bufsize = 0;
@@ -19,9 +19,10 @@
 #include <string>
 #include <SRCMLStatus.hpp>
 #include <Timer.hpp>
+#include <QueryAggregate.hpp>
 
 // creates initial unit, parses, and then sends unit to write queue
-void srcml_consume(int /* thread_pool_id */, std::shared_ptr<ParseRequest> prequest, WriteQueue* write_queue) {
+void srcml_consume(int thread_pool_id, std::shared_ptr<ParseRequest> prequest, WriteQueue* write_queue) {
 
     // error passthrough to output for proper output in trace
     if (prequest->status) {
@@ -110,8 +111,24 @@ void srcml_consume(int /* thread_pool_id */, std::shared_ptr<ParseRequest> prequ
 
     prequest->runtime = parsetime.cpu_time_elapsed();
 
+    // apply each query of a bundle independently to the same unit
+    if (option(SRCML_COMMAND_QUERY_BUNDLE)) {
+        prequest->bundle_results.resize(srcml_archive_get_transform_size(prequest->srcml_arch));
+        srcml_unit_apply_transforms_bundle(prequest->srcml_arch, prequest->unit.get(), prequest->bundle_results.data());
+
+        write_queue->schedule(std::move(prequest));
+        return;
+    }
+
     // perform any transformations and add them to the request
     srcml_unit_apply_transforms(prequest->srcml_arch, prequest->unit.get(), &(prequest->results));
+
+    // reduce scalar results in this thread, so only the final answer is output
+    if (prequest->results && option(SRCML_COMMAND_AGGREGATE) && QueryAggregate::add(thread_pool_id, prequest->results)) {
+        srcml_transform_free(prequest->results);
+        prequest->results = nullptr;
+        prequest->unit.reset();
+    }
     if (prequest->results && srcml_transform_get_type(prequest->results) == SRCML_RESULT_NONE) {
         prequest->unit.reset();
     }
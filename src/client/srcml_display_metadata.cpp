@@ -153,6 +153,18 @@ void srcml_display_metadata(const srcml_request_t& srcml_request, const srcml_in
             return;
         }
 
+        // sidecar index of the units for random access
+        if (option(SRCML_COMMAND_INDEX) && srcml_archive_write_index(srcml_arch.get()) != SRCML_STATUS_OK) {
+            SRCMLstatus(ERROR_MSG, "srcml: Unable to index srcml file %s", src_prefix_resource(input));
+            return;
+        }
+
+        // sidecar index of the terms in the units for skipping units in queries
+        if (option(SRCML_COMMAND_TERM_INDEX) && srcml_archive_write_term_index(srcml_arch.get()) != SRCML_STATUS_OK) {
+            SRCMLstatus(ERROR_MSG, "srcml: Unable to index the terms of srcml file %s", src_prefix_resource(input));
+            return;
+        }
+
         // Overrides all others Perform a pretty output
         if (srcml_request.pretty_format) {
             srcml_pretty(srcml_arch.get(), *srcml_request.pretty_format, srcml_request);
@@ -17,9 +17,31 @@
 #include <SRCMLStatus.hpp>
 #include <OpenFileLimiter.hpp>
 #include <string_view>
+#if defined(__GNUC__) && (__GNUC__ == 7) && (__GNUC_MINOR__ == 5) && (__GNUC_PATCHLEVEL__ == 0)
+    #include <experimental/filesystem>
+    namespace fs = std::experimental::filesystem;
+#else
+    #include <filesystem>
+    namespace fs = std::filesystem;
+#endif
 
 using namespace ::std::literals::string_view_literals;
 
+// smallest srcML file read in parallel, since it is first indexed by a scan of the file
+static const std::uintmax_t PARALLEL_READ_SIZE = 8 * 1024 * 1024;
+
+// if the input is a srcML file large enough to read in parallel
+static bool parallel_read_input(const srcml_input_src& input) {
+
+    if (input.protocol != "file"sv || input.arch || input.fd || input.fileptr || !input.compressions.empty() || !input.archives.empty())
+        return false;
+
+    std::error_code ec;
+    const auto size = fs::file_size(input.resource, ec);
+
+    return !ec && size >= PARALLEL_READ_SIZE;
+}
+
 int srcml_input_srcml(ParseQueue& queue,
                        srcml_archive* srcml_output_archive,
                        const srcml_request_t& srcml_request,
@@ -68,8 +90,22 @@ int srcml_input_srcml(ParseQueue& queue,
         }
     }
 
+    // queries skip the units that cannot match, when the input has a current term index
+    if (srcml_archive_get_transform_size(srcml_output_archive))
+        srcml_archive_read_term_index(srcml_input_archive.get());
+
+    // read the requested unit directly when the input supports random access
+    const int requested_unit = option(SRCML_COMMAND_PARSER_TEST) ? srcml_request.unit : srcml_input.unit;
+    std::unique_ptr<srcml_unit> first_unit;
+    if (requested_unit > 0)
+        first_unit.reset(srcml_archive_read_unit_at(srcml_input_archive.get(), (size_t) requested_unit));
+
+    // read all the units of a large file in parallel, split at unit boundaries
+    if (requested_unit == 0 && srcml_request.max_threads > 1 && parallel_read_input(srcml_input))
+        srcml_archive_enable_parallel_read(srcml_input_archive.get(), srcml_request.max_threads);
+
     // move to the correct unit (if needed)
-    for (int i = 1; i < (option(SRCML_COMMAND_PARSER_TEST) ? srcml_request.unit : srcml_input.unit); ++i) {
+    for (int i = 1; !first_unit && i < requested_unit; ++i) {
         if (!srcml_archive_skip_unit(srcml_input_archive.get())) {
             SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_input.unit);
             exit(1);
@@ -80,7 +116,7 @@ int srcml_input_srcml(ParseQueue& queue,
     bool unitFound = false;
 
     // process each entry in the input srcml archive
-    while (std::unique_ptr<srcml_unit> unit{ srcml_archive_read_unit(srcml_input_archive.get())}) {
+    while (std::unique_ptr<srcml_unit> unit{ first_unit ? first_unit.release() : srcml_archive_read_unit(srcml_input_archive.get())}) {
 
         unitFound = true;
 
@@ -32,6 +32,40 @@
 
 using namespace ::std::literals::string_view_literals;
 
+// scalar transformation result as a line of text
+static std::string scalar_result(srcml_transform_result* result) {
+
+    switch (srcml_transform_get_type(result)) {
+    case SRCML_RESULT_BOOLEAN:
+
+        // output as true/false
+        return srcml_transform_get_bool(result) ? "true\n" : "false\n";
+
+    case SRCML_RESULT_NUMBER:
+        {
+            double number = srcml_transform_get_number(result);
+            if (number != (int) number)
+                return std::to_string(number) + '\n';
+
+            return std::to_string((int) number) + '\n';
+        }
+
+    case SRCML_RESULT_STRING:
+        {
+            const char* value = srcml_transform_get_string(result);
+            std::string s = value ? value : "";
+
+            // if the string does not end in a newline, output one
+            if (s.empty() || s.back() != '\n')
+                s += '\n';
+
+            return s;
+        }
+    };
+
+    return "";
+}
+
 // Public consumption thread function
 void srcml_write_request(std::shared_ptr<ParseRequest> prequest, TraceLog& log, const srcml_output_dest& /* destination */) {
 
@@ -98,45 +132,39 @@ void srcml_write_request(std::shared_ptr<ParseRequest> prequest, TraceLog& log,
         srcml_archive_write_open_filename(output_archive, path.string().c_str());
     }
 
-    // output scalar results
-    if (prequest->results) {
-        switch (srcml_transform_get_type(prequest->results)) {
-        case SRCML_RESULT_BOOLEAN:
-            {
-                // output as true/false with newline after every results
-                std::string_view boolresult = srcml_transform_get_bool(prequest->results) ? "true\n" : "false\n";
-                srcml_archive_write_string(output_archive, boolresult.data(), (int) boolresult.size());
-            }
-            srcml_transform_free(prequest->results);
-            return;
-
-        case SRCML_RESULT_NUMBER:
-            {
-                std::string s;
-                if (srcml_transform_get_number(prequest->results) != (int) srcml_transform_get_number(prequest->results))
-                    s = std::to_string(srcml_transform_get_number(prequest->results));
-                else
-                    s = std::to_string((int) srcml_transform_get_number(prequest->results));
-
+    // output the results of each query of a bundle, tagged with the query number
+    if (!prequest->bundle_results.empty()) {
+        for (std::size_t pos = 0; pos < prequest->bundle_results.size(); ++pos) {
+            auto result = prequest->bundle_results[pos];
+            const auto query = std::to_string(pos + 1);
+
+            int type = srcml_transform_get_type(result);
+            if (type == SRCML_RESULT_UNITS) {
+                srcml_archive_disable_solitary_unit(output_archive);
+                for (int i = 0; i < srcml_transform_get_unit_size(result); ++i) {
+                    auto unit = srcml_transform_get_unit(result, i);
+                    srcml_unit_add_attribute(unit, "", "query", query.data());
+                    srcml_archive_write_unit(output_archive, unit);
+                }
+            } else if (type != SRCML_RESULT_NONE) {
+                auto s = query + '\t' + scalar_result(result);
                 srcml_archive_write_string(output_archive, s.data(), (int) s.size());
-
-                // output a newline after every result
-                srcml_archive_write_string(output_archive, "\n", 1);
             }
-            srcml_transform_free(prequest->results);
-            return;
 
-        case SRCML_RESULT_STRING:
-            std::string_view s = srcml_transform_get_string(prequest->results);
-            srcml_archive_write_string(output_archive, s.data(), (int) s.size());
+            srcml_transform_free(result);
+        }
+        return;
+    }
 
-            // if the string does not end in a newline, output one
-            if (s.back() != '\n')
-                srcml_archive_write_string(output_archive, "\n", 1);
+    // output scalar results
+    if (prequest->results && srcml_transform_get_type(prequest->results) != SRCML_RESULT_UNITS
+                          && srcml_transform_get_type(prequest->results) != SRCML_RESULT_NONE) {
 
-            srcml_transform_free(prequest->results);
-            return;
-        };
+        auto s = scalar_result(prequest->results);
+        srcml_archive_write_string(output_archive, s.data(), (int) s.size());
+
+        srcml_transform_free(prequest->results);
+        return;
     }
 
     // write the unit
@@ -150,24 +178,35 @@ void srcml_write_request(std::shared_ptr<ParseRequest> prequest, TraceLog& log,
             srcml_archive_disable_solitary_unit(output_archive);
         }
 
-        // write out any transformed units
+        // write out any transformed units, with query results written directly
         if (prequest->results) {
-            for (int i = 0; i < srcml_transform_get_unit_size(prequest->results); ++i) {
-                srcml_archive_write_unit(output_archive, srcml_transform_get_unit(prequest->results, i));
-            }
+            srcml_archive_write_transform_result(output_archive, prequest->results);
         }
         // if no transformed units, write the main unit
         if ((!prequest->results || srcml_transform_get_unit_size(prequest->results) == 0) && prequest->unit) {
             int status = SRCML_STATUS_OK;
             if (option(SRCML_COMMAND_XML_FRAGMENT)) {
-                std::string_view s = srcml_unit_get_srcml_outer(prequest->unit.get());
-                status = srcml_archive_write_string(output_archive, s.data(), (int) s.size());
-                if (s.back() != '\n') {
+                // write the ranges of the unit srcML directly, without a fragment copy
+                const char* data[3];
+                size_t sizes[3];
+                int count = 0;
+                status = srcml_unit_get_srcml_outer_view(prequest->unit.get(), data, sizes, &count);
+                char last = '\0';
+                for (int i = 0; status == SRCML_STATUS_OK && i < count; ++i) {
+                    status = srcml_archive_write_string(output_archive, data[i], (int) sizes[i]);
+                    if (sizes[i])
+                        last = data[i][sizes[i] - 1];
+                }
+                if (last != '\n') {
                     srcml_archive_write_string(output_archive, "\n", 1);
                 }
             } else if (option(SRCML_COMMAND_XML_RAW)) {
-                std::string_view s = srcml_unit_get_srcml_inner(prequest->unit.get());
-                status = srcml_archive_write_string(output_archive, s.data(), (int) s.size());
+                const char* data = nullptr;
+                size_t size = 0;
+                status = srcml_unit_get_srcml_inner_view(prequest->unit.get(), &data, &size);
+                std::string_view s(data, size);
+                if (status == SRCML_STATUS_OK)
+                    status = srcml_archive_write_string(output_archive, s.data(), (int) s.size());
                 // when non-blank and does not end in newline, add one in
                 if (!s.empty() && s.back() != '\n') {
                     srcml_archive_write_string(output_archive, "\n", 1);
@@ -190,8 +229,12 @@ void srcml_write_request(std::shared_ptr<ParseRequest> prequest, TraceLog& log,
 
                     first = false;
                 }
-                std::string_view s = srcml_unit_get_srcml_inner(prequest->unit.get());
-                status = srcml_archive_write_string(output_archive, s.data(), (int) s.size());
+                const char* data = nullptr;
+                size_t size = 0;
+                status = srcml_unit_get_srcml_inner_view(prequest->unit.get(), &data, &size);
+                std::string_view s(data, size);
+                if (status == SRCML_STATUS_OK)
+                    status = srcml_archive_write_string(output_archive, s.data(), (int) s.size());
                 // when non-blank and does not end in newline, add one in
                 if (!s.empty() && s.back() != '\n') {
                     srcml_archive_write_string(output_archive, "\n", 1);
@@ -13,12 +13,16 @@
 #include <libxml/parser.h>
 #include <libxml/xpath.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <libxml2_utilities.hpp>
 #include <memory>
 #include <optional>
 #include <srcml.h>
 
+class xpath_stream;
+struct unit_index_query;
+
 struct TransformationResult {
     TransformationResult(xmlNodeSetPtr nodeset = nullptr, bool wrapped = false)
         : nodeset(nodeset), unitWrapped(wrapped) {}
@@ -31,6 +35,12 @@ struct TransformationResult {
     std::shared_ptr<xmlDoc> doc;
 };
 
+struct ValidationResult {
+    bool valid = false;
+    bool usesCpp = false;
+    bool usesOpenMP = false;
+};
+
 /**
  * Transformation
  *
@@ -48,6 +58,45 @@ public :
      */
     virtual TransformationResult apply(xmlDocPtr doc, int position) const = 0;
 
+    /**
+     * modifies_document
+     *
+     * @returns true if apply changes the doc it is applied to
+     */
+    virtual bool modifies_document() const { return false; }
+
+    /**
+     * stream
+     *
+     * @returns the form of the transformation evaluated on SAX events, or null if it needs a DOM
+     */
+    virtual const xpath_stream* stream() const { return nullptr; }
+
+    /**
+     * index_query
+     * @param language the language of the unit
+     *
+     * @returns the terms a unit must contain for a result, or null if they are not known
+     */
+    virtual const unit_index_query* index_query(int /* language */) const { return nullptr; }
+
+    /**
+     * rejects
+     * @param srcml the srcML of the unit
+     * @param language the language of the unit
+     *
+     * @returns true if a quick scan of the srcML shows the unit has no result
+     */
+    virtual bool rejects(std::string_view /* srcml */, int /* language */) const { return false; }
+
+    /**
+     * validate
+     * @param srcml the srcML of the unit
+     *
+     * @returns the validation of the srcML without a DOM, or std::nullopt if not a validation
+     */
+    virtual std::optional<ValidationResult> validate(std::string_view /* srcml */) const { return std::nullopt; }
+
     virtual ~Transformation() {}
 
       /** XSLT parameters */
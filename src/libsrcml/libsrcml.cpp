@@ -13,6 +13,7 @@
 
 #include <Language.hpp>
 #include <language_extension_registry.hpp>
+#include <xsltTransformation.hpp>
 #include <stdlib.h>
 
 #include <vector>
@@ -79,6 +80,7 @@ void srcml_cleanup_globals() {
 
     // automatic on library unloading, but this lets
     // it be done earlier
+    xsltTransformation::cleanup();
     xmlCleanupParser();
 }
 
@@ -12,13 +12,37 @@
 #include <algorithm>
 #include <string>
 #include <cstring>
+#include <fstream>
 #include <unordered_map>
 #include <mutex>
 #include <shared_mutex>
+#include <cstdio>
 
-static std::unordered_map<std::string, std::string> queries;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// XPath and features of a query, converted once for each language
+struct srcql_query {
+    std::string xpath;
+    srcql_features features;
+};
+
+static std::unordered_map<std::string, srcql_query> queries;
 static std::shared_mutex queries_mutex;
 
+// Persistent cache of the converted queries, not used when empty
+static std::string cache_filename;
+
+// First line of a cache file in the current format
+static const char* const CACHE_FORMAT = "srcql-cache 2";
+
+// Kind of file, from its first lines
+enum class cache_kind { EMPTY, NOT_CACHE, OTHER_VERSION, CURRENT };
+
 // The current version of srcQL as a number
 int srcql_version_number() {
     return SRCQL_VERSION_NUMBER;
@@ -29,34 +53,262 @@ const char* srcql_version_string() {
     return SRCQL_VERSION_STRING;
 }
 
-const char* srcql_convert_query_to_xpath(const char* src_query, const char* language) {
+// Version line of a cache file, conversions depend on both srcQL and srcML versions
+static std::string cache_version() {
+    return std::string("version\t") + SRCQL_VERSION_STRING + "\t" + srcml_version_string();
+}
+
+// Escape the characters that separate the fields and lines of a cache file
+static std::string cache_escape(std::string_view value) {
+    std::string result;
+    for (char c : value) {
+        switch (c) {
+        case '&':  result += "&amp;"; break;
+        case '\t': result += "&#9;"; break;
+        case '\n': result += "&#10;"; break;
+        case '\r': result += "&#13;"; break;
+        default:   result += c;
+        }
+    }
+    return result;
+}
+
+static std::string cache_unescape(std::string_view value) {
+    std::string result;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '&') { result += value[i]; continue; }
+
+        for (auto [escaped, c] : { std::make_pair("&amp;", '&'), std::make_pair("&#9;", '\t'), std::make_pair("&#10;", '\n'), std::make_pair("&#13;", '\r') }) {
+            if (value.compare(i, strlen(escaped), escaped) == 0) {
+                result += c;
+                i += strlen(escaped) - 1;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+// Kind of cache file, any earlier format of cache is of other versions
+static cache_kind cache_read_kind(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in || in.peek() == std::ifstream::traits_type::eof()) { return cache_kind::EMPTY; }
+
+    std::string line;
+    if (!std::getline(in, line) || line.rfind("srcql-cache ", 0) != 0) { return cache_kind::NOT_CACHE; }
+    if (line != CACHE_FORMAT || !std::getline(in, line) || line != cache_version()) { return cache_kind::OTHER_VERSION; }
+
+    return cache_kind::CURRENT;
+}
+
+// Separator before an appended entry, a torn last line is ended first
+static std::string cache_separator(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in || in.tellg() <= 0) { return ""; }
+    in.seekg(-1, std::ios::end);
+
+    return in.get() == '\n' ? "" : "\n";
+}
+
+// Replace the cache file with a new file, renamed so that no reader sees a partial file
+static void cache_replace(const std::string& contents) {
+#ifndef _WIN32
+    std::string temp_filename = cache_filename + ".XXXXXX";
+    int fd = mkstemp(temp_filename.data());
+    if (fd == -1) { return; }
+    fchmod(fd, 0644);
+    const bool written = write(fd, contents.data(), contents.size()) == (ssize_t) contents.size();
+    close(fd);
+#else
+    const std::string temp_filename = cache_filename + ".tmp";
+    std::ofstream out(temp_filename, std::ios::binary | std::ios::trunc);
+    out << contents;
+    out.close();
+    const bool written = bool(out);
+
+    // rename() does not replace an existing file
+    if (written) { std::remove(cache_filename.data()); }
+#endif
+    if (!written || std::rename(temp_filename.data(), cache_filename.data()) != 0) {
+        std::remove(temp_filename.data());
+    }
+}
+
+// Add a new conversion to the cache file, replacing a file of other versions.
+// Each entry is a single append under a lock on the file, ending with a line
+// "end", so other processes never read part of an entry as complete.
+static void cache_write(const std::string& key, const srcql_query& query) {
+    if (cache_filename.empty()) { return; }
+
+    std::string entry = "query\t" + cache_escape(key) + "\t" + cache_escape(query.xpath) + "\n";
+    for (const auto& element : query.features.elements) {
+        entry += "element\t" + cache_escape(element) + "\n";
+    }
+    for (const auto& text : query.features.text) {
+        entry += "text\t" + cache_escape(text) + "\n";
+    }
+    entry += "end\n";
+
+    const std::string header = std::string(CACHE_FORMAT) + "\n" + cache_version() + "\n";
+
+#ifndef _WIN32
+    // another process may replace the file while this one waits for the lock
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        int fd = open(cache_filename.data(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+        if (fd == -1) { return; }
+
+        struct stat locked;
+        struct stat named;
+        if (flock(fd, LOCK_EX) != 0 || fstat(fd, &locked) != 0) { close(fd); return; }
+        if (stat(cache_filename.data(), &named) != 0 || named.st_ino != locked.st_ino || named.st_dev != locked.st_dev) {
+            close(fd);
+            continue;
+        }
+
+        const auto kind = cache_read_kind(cache_filename);
+        if (kind == cache_kind::EMPTY || kind == cache_kind::CURRENT) {
+            const std::string contents = kind == cache_kind::EMPTY ? header + entry : cache_separator(cache_filename) + entry;
+            [[maybe_unused]] auto written = write(fd, contents.data(), contents.size());
+        } else if (kind == cache_kind::OTHER_VERSION) {
+            cache_replace(header + entry);
+        }
+
+        // closing releases the lock
+        close(fd);
+        return;
+    }
+#else
+    const auto kind = cache_read_kind(cache_filename);
+    if (kind == cache_kind::EMPTY || kind == cache_kind::CURRENT) {
+        const std::string contents = kind == cache_kind::EMPTY ? header + entry : cache_separator(cache_filename) + entry;
+        std::ofstream out(cache_filename, std::ios::binary | std::ios::app);
+        out.write(contents.data(), (std::streamsize) contents.size());
+    } else if (kind == cache_kind::OTHER_VERSION) {
+        cache_replace(header + entry);
+    }
+#endif
+}
+
+bool srcql_set_cache(const char* filename) {
+    std::unique_lock lock(queries_mutex);
+
+    cache_filename = "";
+
+    // never replace a file that is not a cache
+    const auto kind = cache_read_kind(filename);
+    if (kind == cache_kind::NOT_CACHE) { return false; }
+    cache_filename = filename;
+
+    // a new file, or a cache of other versions, is replaced by the first conversion
+    if (kind != cache_kind::CURRENT) { return true; }
+
+    std::ifstream in(filename, std::ios::binary);
+    std::string line;
+    std::getline(in, line);
+    std::getline(in, line);
+
+    // an entry is only used once its end line is read, so a torn or
+    // unparsable entry is a miss, and is converted again
+    std::string key;
+    srcql_query query;
+    bool pending = false;
+    while (std::getline(in, line) && !in.eof()) {
+        auto tab = line.find('\t');
+        std::string_view field(line.data(), tab == std::string::npos ? line.size() : tab);
+        std::string_view value = tab == std::string::npos ? std::string_view() : std::string_view(line).substr(tab + 1);
+
+        // escaped values never contain a tab
+        auto second_tab = value.find('\t');
+        if (field == "query" && second_tab != std::string_view::npos && value.find('\t', second_tab + 1) == std::string_view::npos) {
+            key = cache_unescape(value.substr(0, second_tab));
+            query = srcql_query{ cache_unescape(value.substr(second_tab + 1)), srcql_features() };
+            pending = true;
+        }
+        else if (pending && field == "element" && tab != std::string::npos && second_tab == std::string_view::npos) {
+            query.features.elements.push_back(cache_unescape(value));
+        }
+        else if (pending && field == "text" && tab != std::string::npos && second_tab == std::string_view::npos) {
+            query.features.text.push_back(cache_unescape(value));
+        }
+        else if (pending && line == "end") {
+            queries.emplace(std::move(key), std::move(query));
+            pending = false;
+        }
+        else { pending = false; }
+    }
+
+    return true;
+}
+
+// Converted query, entries are never removed so the reference stays valid
+static const srcql_query& convert_query(const char* src_query, const char* language) {
     std::string key = std::string(language)+":"+src_query;
-    std::string xpath;
 
     // Shared lock for read
     {
         std::shared_lock lock(queries_mutex);
         if (auto search = queries.find(key); search != queries.end()) {
-            xpath = search->second;
+            return search->second;
         }
     }
 
-    if(xpath.empty()) {
-        // Unqiue lock for write
-        std::unique_lock lock(queries_mutex);
+    // Unqiue lock for write
+    std::unique_lock lock(queries_mutex);
 
-        if (auto search = queries.find(key); search != queries.end()) {
-            xpath = search->second;
-        }
-        else {
-            XPathGenerator generator(src_query,language);
-            xpath = generator.convert();
-            queries.insert(std::make_pair(key,xpath));
-        }
+    if (auto search = queries.find(key); search != queries.end()) {
+        return search->second;
     }
 
+    XPathGenerator generator(src_query,language);
+    srcql_query query;
+    query.xpath = generator.convert();
+    query.features = generator.get_features();
+
+    cache_write(key, query);
+
+    return queries.insert(std::make_pair(key,std::move(query))).first->second;
+}
+
+const char* srcql_convert_query_to_xpath(const char* src_query, const char* language) {
+    const std::string& xpath = convert_query(src_query, language).xpath;
+
     char* returned_xpath = new char[xpath.length()+1];
     strcpy(returned_xpath,xpath.c_str());
     return returned_xpath;
 }
 
+srcql_features srcql_query_features(const char* src_query, const char* language) {
+    return convert_query(src_query, language).features;
+}
+
+bool srcql_features_found(const srcql_features& features, std::string_view srcml) {
+
+    // start tag of each element, with any prefix
+    for (const auto& element : features.elements) {
+        std::string_view local(element);
+        if (auto colon = local.rfind(':'); colon != std::string_view::npos) {
+            local.remove_prefix(colon+1);
+        }
+        if (local.empty() || local == "*") { continue; }
+
+        bool found = false;
+        for (auto pos = srcml.find(local); !found && pos != std::string_view::npos; pos = srcml.find(local,pos+1)) {
+            if (pos == 0 || pos + local.size() >= srcml.size()) { continue; }
+            const char before = srcml[pos-1];
+            const char after = srcml[pos+local.size()];
+            found = (before == '<' || before == ':') &&
+                    (after == '>' || after == '/' || after == ' ' || after == '\t' || after == '\n' || after == '\r');
+        }
+        if (!found) { return false; }
+    }
+
+    // text of each element, only when srcML does not escape it
+    for (const auto& text : features.text) {
+        const bool literal = !text.empty() && std::all_of(text.begin(), text.end(), [](char c) {
+            return c >= ' ' && c <= '~' && !strchr("&<>\"'", c);
+        });
+        if (literal && srcml.find(">"+text+"<") == std::string_view::npos) { return false; }
+    }
+
+    return true;
+}
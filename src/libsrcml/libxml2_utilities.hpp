@@ -13,6 +13,7 @@
 #include <libxml/tree.h>
 #include <libxml/xmlIO.h>
 #include <libxml/relaxng.h>
+#include <libxml/xmlreader.h>
 #include <algorithm>
 #include <memory>
 
@@ -73,6 +74,11 @@ namespace std {
     struct default_delete<xmlRelaxNG> {
         void operator()(xmlRelaxNG* rng) { xmlRelaxNGFree(rng); }
     };
+
+    template<>
+    struct default_delete<xmlTextReader> {
+        void operator()(xmlTextReader* reader) { xmlFreeTextReader(reader); }
+    };
 }
 
 #endif
@@ -55,16 +55,14 @@ namespace {
     void get_node_text(const xmlNode* top_node, std::string& text, bool top) {
         // process list of nodes
         for (const xmlNode* node = top_node; node != NULL && (!top || node == top_node); node = node->next) {
-            if (node->type == XML_TEXT_NODE) {
-                xmlChar* t = xmlNodeGetContent(node);
-                std::string_view st((const char*) t);
+            if (node->type == XML_TEXT_NODE && node->content) {
+                std::string_view st((const char*) node->content);
 
                 // add normalized whitespace to the text
                 if (st.find_first_not_of(" \t\n\r") != st.npos) {
                     text += trim_whitespace(st);
                     text += ' ';
                 }
-                xmlFree(t);
             }
 
             // process children depth first
@@ -75,12 +73,27 @@ namespace {
     }
 
     // node text with normalized whitespace
-    std::string get_node_text(const xmlNode* top_node) {
+    // valid until the next call, as the buffer is reused
+    std::string_view get_node_text(const xmlNode* top_node) {
         // use single string to avoid copying
-        std::string s;
+        thread_local std::string s;
+        s.clear();
         get_node_text(top_node, s, true);
         return s;
     }
+
+    // variable ids are interned by XPathGenerator, and are small
+    constexpr double MAX_VARIABLE_ID = 1 << 16;
+
+    // pop the variable id, returning false if not a valid id
+    bool pop_variable(xmlXPathParserContext* ctxt, size_t& variable) {
+        const double id = xmlXPathPopNumber(ctxt);
+        if (!(id >= 0 && id < MAX_VARIABLE_ID))
+            return false;
+
+        variable = (size_t) id;
+        return true;
+    }
 }
 
 void add_element(xmlXPathParserContext* ctxt, int nargs) {
@@ -105,12 +118,13 @@ void add_element(xmlXPathParserContext* ctxt, int nargs) {
         prefix = (const char*)(ctxtPrefix.get());
     }
 
-    // order ?
+    // order ?, which starts at 1
     size_t number = (size_t) xmlXPathPopNumber(ctxt);
+    const bool validOrder = number >= 1;
 
-    // bucket name
-    std::unique_ptr<xmlChar> ctxtBucket(xmlXPathPopString(ctxt));
-    const std::string_view bucket = (char*)(ctxtBucket.get());
+    // bucket variable id
+    size_t bucket = 0;
+    const bool validBucket = pop_variable(ctxt, bucket);
 
     // token
     std::unique_ptr<xmlNodeSet> node_set(xmlXPathPopNodeSet(ctxt));
@@ -121,11 +135,11 @@ void add_element(xmlXPathParserContext* ctxt, int nargs) {
     UnificationTable* table = (UnificationTable*)(ctxt->context->userData);
 
     bool isValid = false;
-    for (int i = 0; i < node_set.get()->nodeNr; ++i) {
+    for (int i = 0; validBucket && validOrder && i < node_set.get()->nodeNr; ++i) {
 
         const xmlNode* node = node_set.get()->nodeTab[i];
 
-        const std::string token(get_node_text(node));
+        const std::string_view token(get_node_text(node));
         const auto node_ptr = reinterpret_cast<std::uintptr_t>(node);
 
         // @NOTE Add comment
@@ -194,9 +208,9 @@ void match_element(xmlXPathParserContext* ctxt, int nargs) {
     // order ?
     //size_t number = (size_t) xmlXPathPopNumber(ctxt);
 
-    // bucket name
-    std::unique_ptr<xmlChar> ctxtBucket(xmlXPathPopString(ctxt));
-    const std::string_view bucket = (char*)(ctxtBucket.get());
+    // bucket variable id
+    size_t bucket = 0;
+    const bool validBucket = pop_variable(ctxt, bucket);
 
     // token
     std::unique_ptr<xmlNodeSet> node_set(xmlXPathPopNodeSet(ctxt));
@@ -207,7 +221,7 @@ void match_element(xmlXPathParserContext* ctxt, int nargs) {
     UnificationTable* table = (UnificationTable*)(ctxt->context->userData);
 
     bool isValid = false;
-    for (int i = 0; i < node_set.get()->nodeNr; ++i) {
+    for (int i = 0; validBucket && i < node_set.get()->nodeNr; ++i) {
 
         const xmlNode* node = node_set.get()->nodeTab[i];
 
@@ -223,7 +237,7 @@ void match_element(xmlXPathParserContext* ctxt, int nargs) {
             return;
         }
 
-        const std::string token(get_node_text(node));
+        const std::string_view token(get_node_text(node));
         const auto node_ptr = reinterpret_cast<std::uintptr_t>(node);
 
         // @NOTE Add comment
@@ -271,9 +285,9 @@ void clear_elements(xmlXPathParserContext* ctxt, int nargs) {
     } else if (nargs == 1) {
 
         // clear this bucket
-        xmlChar* var = xmlXPathPopString(ctxt);
-        table->empty_bucket((const char*) var);
-        xmlFree(var);
+        size_t variable = 0;
+        if (pop_variable(ctxt, variable))
+            table->empty_bucket(variable);
     }
 
     // always true
@@ -314,14 +328,13 @@ void regex_match(xmlXPathParserContext* ctxt, int nargs) {
         std::cerr << "Arg arity error" << std::endl;
         return;
     }
-    xmlChar* r = xmlXPathPopString(ctxt);
-    std::string regex = (const char*)(r);
-    xmlChar* id = xmlXPathPopString(ctxt);
-    std::string identifier = (const char*)(id);
-    identifier = identifier.substr(1,identifier.size()-1);
+    std::unique_ptr<xmlChar> regex(xmlXPathPopString(ctxt));
+    size_t identifier = 0;
+    const bool validIdentifier = pop_variable(ctxt, identifier);
 
     UnificationTable* table = (UnificationTable*)(ctxt->context->userData);
-    table->add_regex_rule(identifier,regex);
+    if (validIdentifier)
+        table->add_regex_rule(identifier, (const char*) regex.get());
 
     xmlXPathReturnBoolean(ctxt, true);
 }
@@ -348,7 +361,7 @@ void debug_print(xmlXPathParserContext* ctxt, int nargs) {
 
     for (int i = 0; i < set->nodeNr; ++i) {
         xmlNode* node = set->nodeTab[i];
-        const std::string token(get_node_text(node));
+        const std::string_view token(get_node_text(node));
         std::cerr << "\t" << prefix << i << ": " << token << " | " << node << std::endl;
     }
 
@@ -8,6 +8,11 @@
  */
 
 #include <relaxngTransformation.hpp>
+#include <srcmlns.hpp>
+
+#include <libxml/xmlreader.h>
+
+#include <string_view>
 
 /**
  * relaxngTransformation
@@ -50,3 +55,66 @@ TransformationResult relaxngTransformation::apply(xmlDocPtr doc, int /* position
     result.nodeType = SRCML_RESULT_UNITS;
     return result;
 }
+
+/**
+ * validate
+ * @param srcml the srcML of the unit
+ *
+ * Validate the srcML as it is read, with a reader that is reused for the
+ * following units. The validation context is new for each unit, since
+ * libxml2 does not reset its state at the end of a document.
+ *
+ * @returns the validation, or std::nullopt if the srcML could not be read
+ */
+std::optional<ValidationResult> relaxngTransformation::validate(std::string_view srcml) const {
+
+    // take an unused reader, or create one
+    std::unique_ptr<xmlTextReader> reader;
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        if (!readers.empty()) {
+            reader = std::move(readers.back());
+            readers.pop_back();
+        }
+    }
+    if (!reader)
+        reader.reset(xmlReaderForMemory(srcml.data(), (int) srcml.size(), 0, 0, XML_PARSE_HUGE));
+    else if (xmlReaderNewMemory(reader.get(), srcml.data(), (int) srcml.size(), 0, 0, XML_PARSE_HUGE) != 0)
+        return std::nullopt;
+    if (!reader)
+        return std::nullopt;
+
+    // the reader does not free the context, and forgets it when given the next one
+    std::unique_ptr<xmlRelaxNGValidCtxt> context(xmlRelaxNGNewValidCtxt(rng.get()));
+    if (!context || xmlTextReaderRelaxNGValidateCtxt(reader.get(), context.get(), 0) != 0)
+        return std::nullopt;
+
+    // elements in the cpp and openmp namespaces
+    ValidationResult validation;
+    int status = 0;
+    while ((status = xmlTextReaderRead(reader.get())) == 1) {
+
+        if (xmlTextReaderNodeType(reader.get()) != XML_READER_TYPE_ELEMENT || !xmlTextReaderConstPrefix(reader.get()))
+            continue;
+
+        const char* uri = (const char*) xmlTextReaderConstNamespaceUri(reader.get());
+        if (!uri)
+            continue;
+
+        if (SRCML_CPP_NS_URI == std::string_view(uri))
+            validation.usesCpp = true;
+        else if (SRCML_OPENMP_NS_URI == std::string_view(uri))
+            validation.usesOpenMP = true;
+    }
+
+    // srcML that is not well-formed is reported by the DOM
+    if (status != 0)
+        return std::nullopt;
+
+    validation.valid = xmlTextReaderIsValid(reader.get()) == 1;
+
+    std::lock_guard<std::mutex> lock(readers_mutex);
+    readers.push_back(std::move(reader));
+
+    return validation;
+}
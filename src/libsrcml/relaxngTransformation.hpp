@@ -16,6 +16,7 @@
 #include <libxml2_utilities.hpp>
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -49,9 +50,21 @@ public :
      */
     virtual TransformationResult apply(xmlDocPtr doc, int position) const;
 
+    /**
+     * validate
+     * @param srcml the srcML of the unit
+     *
+     * Validate the srcML as it is read, without a DOM.
+     */
+    virtual std::optional<ValidationResult> validate(std::string_view srcml) const;
+
 private :
     const std::unique_ptr<xmlRelaxNGParserCtxt> relaxng_parser_ctxt;
     const std::unique_ptr<xmlRelaxNG> rng;
+
+    // readers not in use, so each thread reuses one
+    mutable std::vector<std::unique_ptr<xmlTextReader>> readers;
+    mutable std::mutex readers_mutex;
 };
 
 #endif
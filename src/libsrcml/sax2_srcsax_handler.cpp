@@ -246,6 +246,10 @@ void start_root(void* ctx, const xmlChar* localname, const xmlChar* prefix, cons
 
     state->mode = ROOT;
 
+    // whitespace after the xml declaration is not part of the root start tag
+    while (state->base < ctxt->input->cur && *state->base != '<')
+        ++state->base;
+
     // save the root start tag because we are going to parse it again to generate proper start_root() and start_unit()
     // calls after we know whether this is an archive or not
     state->rootstarttag.reserve(static_cast<std::size_t>(ctxt->input->cur - state->base + 2));
@@ -511,6 +515,34 @@ void start_unit(void* ctx, const xmlChar* localname, const xmlChar* prefix, cons
     SRCSAX_DEBUG_END(localname);
 }
 
+/**
+ * skip_unit_body
+ * @param ctx an xmlParserCtxtPtr
+ *
+ * Stop collecting the body of the current unit, e.g.,
+ * when the unit is skipped before its end.
+ */
+void skip_unit_body(void* ctx) {
+
+    auto ctxt = (xmlParserCtxtPtr) ctx;
+    if (ctxt == nullptr)
+        return;
+    auto state = (sax2_srcsax_handler*) ctxt->_private;
+    if (state == nullptr)
+        return;
+
+    state->collect_unit_body = false;
+    state->unitsrcml.clear();
+    state->unitsrc.clear();
+
+    // same handlers as a unit started without collecting the body
+    ctxt->sax->startElementNs = 0;
+    ctxt->sax->ignorableWhitespace = ctxt->sax->characters = 0;
+    ctxt->sax->comment = 0;
+    ctxt->sax->cdataBlock = 0;
+    ctxt->sax->processingInstruction = 0;
+}
+
 /**
  * end_unit
  * @param ctx an xmlParserCtxtPtr
@@ -695,12 +727,16 @@ void end_element(void* ctx, const xmlChar* localname, const xmlChar* prefix, con
 
     // At this point, we have the end of a unit
 
-    if (ctxt->nameNr == 2 || !state->context->is_archive) {
+    // the push parser ends an empty element before pushing its name
+    bool isempty = ctxt->input->cur[-1] == '>' && ctxt->input->cur[-2] == '/';
+    int depth = ctxt->nameNr + (isempty ? 1 : 0);
+
+    if (depth == 2 || !state->context->is_archive) {
 
         end_unit(ctx, localname, prefix, URI);
     }
 
-    if (ctxt->nameNr == 1) {
+    if (depth == 1) {
 
         state->mode = END_ROOT;
 
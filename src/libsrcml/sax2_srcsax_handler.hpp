@@ -171,6 +171,15 @@ void start_unit(void* ctx, const xmlChar* localname, const xmlChar* prefix, cons
                int nb_namespaces, const xmlChar** namespaces, int nb_attributes, int nb_defaulted,
                const xmlChar** attributes);
 
+/**
+ * skip_unit_body
+ * @param ctx an xmlParserCtxtPtr
+ *
+ * Stop collecting the body of the current unit, e.g.,
+ * when the unit is skipped before its end.
+ */
+void skip_unit_body(void* ctx);
+
 /**
  * end_unit
  * @param ctx an xmlParserCtxtPtr
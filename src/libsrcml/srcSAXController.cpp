@@ -56,23 +56,40 @@ srcsax_context * srcSAXController::getContext() {
  */
 void srcSAXController::parse(srcSAXHandler * handler) {
 
-    handler->set_controller(this);
+    while (parse_chunk(handler))
+        ;
+}
 
-    cppCallbackAdapter adapter(handler);
-    context->data = &adapter;
-    srcsax_handler sax_handler = cppCallbackAdapter::factory();
-    context->handler = &sax_handler;
+/**
+ * parse_chunk
+ * @param handler srcMLHandler with hooks for sax parsing
+ *
+ * Parse the next chunk of the xml document with the supplied hooks.
+ *
+ * @returns true if there is more of the document to parse
+ */
+bool srcSAXController::parse_chunk(srcSAXHandler * handler) {
 
-    int status = srcsax_parse(context);
+    // first chunk, so connect the handler
+    if (!adapter) {
 
-    context->data = 0;
+        handler->set_controller(this);
 
-    if (status != 0) {
+        adapter = std::make_unique<cppCallbackAdapter>(handler);
+        context->data = adapter.get();
+        sax_handler = cppCallbackAdapter::factory();
+        context->handler = &sax_handler;
+    }
+
+    int status = srcsax_parse_chunk(context);
+
+    if (status == -1) {
 
         auto ep = xmlCtxtGetLastError(context->libxml2_context);
         SAXError error = { std::string(ep->message), ep->code };
 
         throw error;
     }
-}
 
+    return status == 1;
+}
@@ -676,6 +676,23 @@ LIBSRCML_DECL const char* srcml_archive_error_string(const struct srcml_archive*
  */
 LIBSRCML_DECL int srcml_archive_write_unit(struct srcml_archive* archive, struct srcml_unit* unit);
 
+/**
+ * Convert the files to srcML on multiple threads and append the units to the archive in file order
+ * The filename attribute of each unit is the filename, and the language is from the archive or the file extension
+ * @param archive A srcml_archive opened for writing
+ * @param src_filenames Names of the files to parse into srcML
+ * @param count The number of files
+ * @param threads The number of parsing threads
+ * @param context A context for the callback
+ * @param callback Called on the calling thread, in file order, with the position, status, and unit of each file.
+ * The unit is NULL when the file is not parsed or written. The callback can be NULL.
+ * @return SRCML_STATUS_OK when all files are written
+ * @return Status error code of the first file that is not written
+ * @return SRCML_STATUS_ERROR, with no file written, if the threads cannot be started
+ */
+LIBSRCML_DECL int srcml_archive_parse_batch(struct srcml_archive* archive, const char* const* src_filenames, size_t count, int threads,
+    void* context, void (*callback)(void* context, size_t pos, int status, struct srcml_unit* unit));
+
 /**
  * Append the string to the srcml_archive archive
  * @param archive A srcml_archive opened for writing
@@ -768,6 +785,8 @@ LIBSRCML_DECL int srcml_archive_read_open_filename(struct srcml_archive* archive
 
 /**
  * Open a srcML archive for reading from a buffer up until a buffer_size
+ * For srcml_archive_read_unit_at(), srcml_archive_read_unit_by_filename(),
+ * and srcml_archive_enable_parallel_read(), the buffer must remain valid until the archive is closed
  * @param archive A srcml_archive
  * @param buffer An input buffer
  * @param buffer_size Size of the input buffer
@@ -1146,6 +1165,77 @@ LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* a
  * @return NULL on failure
  */
 LIBSRCML_DECL int srcml_archive_skip_unit(struct srcml_archive* archive);
+
+/**
+ * Read the unit at a position in the archive without reading the preceding units
+ * Uses the sidecar index file of the archive if current, otherwise indexes the archive on the first call.
+ * Does not change the position of srcml_archive_read_unit()
+ * @param archive A srcml_archive open for reading from a filename or memory
+ * @param pos The position of the unit, starting at 1
+ * @return The read srcml_unit on success
+ * @return NULL on failure, or if the archive cannot be indexed
+ */
+LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit_at(struct srcml_archive* archive, size_t pos);
+
+/**
+ * Read the first unit with a filename attribute without reading the other units
+ * Does not change the position of srcml_archive_read_unit()
+ * @param archive A srcml_archive open for reading from a filename or memory
+ * @param filename The filename attribute of the unit
+ * @return The read srcml_unit on success
+ * @return NULL if not found, on failure, or if the archive cannot be indexed
+ */
+LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit_by_filename(struct srcml_archive* archive, const char* filename);
+
+/**
+ * Write the sidecar index file of the archive, the srcML filename with ".idx" appended
+ * The index records the byte offset, length, filename, language, and hash of each unit
+ * @param archive A srcml_archive open for reading from a filename
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION
+ * @retval SRCML_STATUS_IO_ERROR
+ */
+LIBSRCML_DECL int srcml_archive_write_index(struct srcml_archive* archive);
+
+/**
+ * Write the sidecar term index file of the archive, the srcML filename with ".tidx" appended
+ * The term index records the units that contain each element name, src:name text, and attribute value
+ * @param archive A srcml_archive open for reading from a filename
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION
+ * @retval SRCML_STATUS_IO_ERROR on failure, or if the archive cannot be indexed
+ */
+LIBSRCML_DECL int srcml_archive_write_term_index(struct srcml_archive* archive);
+
+/**
+ * Read the sidecar term index file of the archive, if current, to skip units that cannot match a query
+ * The term index is current if the archive has the same size, modification time, and file serial number as when it was indexed
+ * For the units read from the archive, srcml_unit_apply_transforms() and srcml_unit_apply_transforms_bundle()
+ * give the empty result, without building the DOM, when a unit does not contain the element names,
+ * src:name text, and attribute values required by an XPath location path, or count() or boolean() of one.
+ * @param archive A srcml_archive open for reading from a filename
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION
+ * @retval SRCML_STATUS_IO_ERROR if there is no current term index file
+ */
+LIBSRCML_DECL int srcml_archive_read_term_index(struct srcml_archive* archive);
+
+/**
+ * Read the units of the archive in parallel, split into chunks at unit boundaries
+ * srcml_archive_read_unit() and srcml_archive_skip_unit() deliver the units in order,
+ * starting with the first unit. Call before the first unit is read.
+ * No units are read after a unit that cannot be parsed, and srcml_archive_error_number() gives the error
+ * @param archive A srcml_archive open for reading from a filename or memory
+ * @param threads The number of parsing threads
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION for a solitary unit, or if the archive cannot be indexed
+ * @retval SRCML_STATUS_IO_ERROR
+ */
+LIBSRCML_DECL int srcml_archive_enable_parallel_read(struct srcml_archive* archive, int threads);
 /**@}*/
 
 /**@{ @name XPath query and XSLT transformations */
@@ -1316,6 +1406,18 @@ LIBSRCML_DECL int srcml_append_transform_srcql_element(struct srcml_archive* arc
                                                             const char* prefix, const char* namespace_uri,
                                                             const char* element);
 
+/**
+ * Use a file as a persistent cache of the conversions of srcQL queries to XPath.
+ * Conversions in the file for the current srcQL and srcML versions are used without
+ * converting the query again, and new conversions are added to the file.
+ * Concurrent processes can share the file, as each conversion is added under a file lock.
+ * @param cache_filename Name of the cache file, created if it does not exist
+ * @return SRCML_STATUS_OK on success
+ * @return SRCML_STATUS_INVALID_INPUT if the file exists and is not a srcQL cache
+ * @return Status error code on failure
+ */
+LIBSRCML_DECL int srcml_set_srcql_cache(const char* cache_filename);
+
 /**
  * Append an XSLT parameter to the last transformation
  * @param archive A srcml_archive
@@ -1364,6 +1466,25 @@ struct srcml_transform_result;
  */
 LIBSRCML_DECL int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit* unit, struct srcml_transform_result** result);
 
+/**
+ * @param archive A srcml archive
+ * @return The number of transformations appended to the archive
+ */
+LIBSRCML_DECL size_t srcml_archive_get_transform_size(const struct srcml_archive* archive);
+
+/**
+ * Apply each appended transformation from the archive to the unit independently, as a bundle of queries.
+ * The unit is parsed into a single DOM that all transformations are evaluated against. Simple path queries,
+ * and count() and boolean() of them, are evaluated on the srcML without the DOM.
+ * Each result in the array is the result of the transformation in that position, and is freed with
+ * srcml_transform_free(), even on error.
+ * @param archive Archive with the transformations declared
+ * @param unit Unit to perform the transformations on
+ * @param results Array of srcml_archive_get_transform_size() results
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+LIBSRCML_DECL int srcml_unit_apply_transforms_bundle(struct srcml_archive* archive, struct srcml_unit* unit, struct srcml_transform_result** results);
+
 /**
  * @param result A srcml transformation result
  * @return The type of the transformation result
@@ -1383,6 +1504,15 @@ LIBSRCML_DECL int srcml_transform_get_unit_size(struct srcml_transform_result* r
  */
 LIBSRCML_DECL struct srcml_unit* srcml_transform_get_unit(struct srcml_transform_result* result, int index);
 
+/**
+ * Write the units of a transformation result to the archive. Result nodes of a query are written
+ * directly, without creating a unit for each one.
+ * @param archive A srcml archive opened for writing
+ * @param result A srcml transformation result
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+LIBSRCML_DECL int srcml_archive_write_transform_result(struct srcml_archive* archive, struct srcml_transform_result* result);
+
 /**
  * @param result A srcml transformation result
  * @return The transformation result string
@@ -1641,6 +1771,19 @@ LIBSRCML_DECL const char* srcml_unit_get_srcml(struct srcml_unit* unit);
  */
 LIBSRCML_DECL const char* srcml_unit_get_srcml_outer(struct srcml_unit* unit);
 
+/**
+ * Get the fragment of the srcML from this unit, as in srcml_unit_get_srcml_outer(), without a copy
+ * The fragment is the concatenation of up to 3 ranges of the srcML stored in the unit
+ * @note Ranges are not null terminated, and are valid until the unit is freed, or another srcml_unit_get_srcml*() is called
+ * @param unit A srcml unit opened for reading
+ * @param data Array of at least 3 pointers, set to the start of each range
+ * @param sizes Array of at least 3 sizes, set to the size of each range
+ * @param count Set to the number of ranges
+ * @return SRCML_STATUS_OK on success
+ * @return Status error code on failure
+ */
+LIBSRCML_DECL int srcml_unit_get_srcml_outer_view(struct srcml_unit* unit, const char* data[3], size_t sizes[3], int* count);
+
 /**
  * Get the srcML without the enclosing unit tags
  * The XML fragment returned is UTF-8 encoded XML. It is not well-formed XML, e.g., it is missing
@@ -1652,6 +1795,17 @@ LIBSRCML_DECL const char* srcml_unit_get_srcml_outer(struct srcml_unit* unit);
  */
 LIBSRCML_DECL const char* srcml_unit_get_srcml_inner(struct srcml_unit* unit);
 
+/**
+ * Get the srcML without the enclosing unit tags, as in srcml_unit_get_srcml_inner(), without a copy
+ * @note View is not null terminated, and is valid until the unit is freed, or another srcml_unit_get_srcml*() is called
+ * @param unit A srcml unit opened for reading
+ * @param data Set to the start of the srcML
+ * @param size Set to the size of the srcML
+ * @return SRCML_STATUS_OK on success
+ * @return Status error code on failure
+ */
+LIBSRCML_DECL int srcml_unit_get_srcml_inner_view(struct srcml_unit* unit, const char** data, size_t* size);
+
 /**
  * @param unit A srcml_unit
  * @return The number of currently defined namespaces or 0 if unit is NULL
@@ -10,7 +10,14 @@
 #include <srcmlns.hpp>
 #include <srcml_translator.hpp>
 #include <srcml_sax2_reader.hpp>
+#include <srcml_parallel_reader.hpp>
+#include <unit_index.hpp>
 #include <libxml/encoding.h>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <sys/stat.h>
 
 /**
  * srcml_archive_check_extension
@@ -108,6 +115,9 @@ void srcml_archive_free(struct srcml_archive* archive) {
     if (archive->xbuffer)
         xmlBufferFree(archive->xbuffer);
 
+    delete archive->parallel_reader;
+    archive->parallel_reader = nullptr;
+
     if (archive->reader) {
         delete archive->reader;
         archive->reader = nullptr;
@@ -142,11 +152,15 @@ srcml_archive* srcml_archive_clone(const struct srcml_archive* archive) {
     new_archive->type = SRCML_ARCHIVE_INVALID;
     new_archive->translator = nullptr;
     new_archive->reader = nullptr;
+    new_archive->parallel_reader = nullptr;
     new_archive->output_buffer = nullptr;
     new_archive->xbuffer = nullptr;
     new_archive->buffer = nullptr;
     new_archive->size = nullptr;
     new_archive->rawwrites = false;
+    new_archive->source_filename.reset();
+    new_archive->source_memory = std::string_view();
+    new_archive->index.reset();
     new_archive->error_string.clear();
     new_archive->error_number = 0;
 
@@ -1115,6 +1129,10 @@ static int srcml_archive_read_open_internal(struct srcml_archive* archive, std::
     if (!input)
         return SRCML_STATUS_IO_ERROR;
 
+    archive->source_filename.reset();
+    archive->source_memory = std::string_view();
+    archive->index.reset();
+
     try {
 
         archive->reader = new srcml_sax2_reader(archive, std::move(input));
@@ -1146,7 +1164,11 @@ int srcml_archive_read_open_filename(struct srcml_archive* archive, const char*
 
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateFilename(srcml_filename, archive->encoding ? xmlParseCharEncoding(archive->encoding->data()) : XML_CHAR_ENCODING_NONE));
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status == SRCML_STATUS_OK)
+        archive->source_filename = srcml_filename;
+
+    return status;
 }
 
 /**
@@ -1156,7 +1178,10 @@ int srcml_archive_read_open_filename(struct srcml_archive* archive, const char*
  * @param buffer_size size of the input buffer
  *
  * Open a srcML archive for reading.  Set the input to be read from
- * the buffer up until buffer_size.
+ * the buffer up until buffer_size. The buffer is not copied for random
+ * access, so it must remain valid until the archive is closed when
+ * units are read with srcml_archive_read_unit_at(),
+ * srcml_archive_read_unit_by_filename(), or in parallel.
  *
  * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
  */
@@ -1190,7 +1215,11 @@ int srcml_archive_read_open_memory(struct srcml_archive* archive, const char* bu
         xmlParserInputBufferGrow(input.get(), buffer_size > 4096 ? (int)buffer_size : 4096);
     }
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status == SRCML_STATUS_OK)
+        archive->source_memory = std::string_view(buffer, buffer_size);
+
+    return status;
 }
 
 /**
@@ -1304,6 +1333,133 @@ int srcml_archive_write_unit(struct srcml_archive* archive, struct srcml_unit* u
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_parse_batch
+ * @param archive a srcml archive opened for writing
+ * @param src_filenames names of the files to parse into srcML
+ * @param count number of files
+ * @param threads number of parsing threads
+ * @param context context for the callback
+ * @param callback called for each file with its position, status, and unit, or NULL
+ *
+ * Convert the files to srcML on worker threads, and append the units
+ * to the archive in the order of the files. The filename attribute of
+ * each unit is the filename, and the language is from the archive or the
+ * file extension. The units are written, and the callback is called, on
+ * the calling thread. The unit passed to the callback is NULL when the
+ * file is not parsed or written, and is freed after the callback.
+ *
+ * @returns Return SRCML_STATUS_OK when all the files are written, or the status
+ * error code of the first file that is not. Returns SRCML_STATUS_ERROR, with
+ * no file written, if the threads cannot be started.
+ */
+int srcml_archive_parse_batch(struct srcml_archive* archive, const char* const* src_filenames, size_t count, int threads,
+    void* context, void (*callback)(void* context, size_t pos, int status, struct srcml_unit* unit)) {
+
+    if (archive == nullptr || (count && src_filenames == nullptr) || threads < 1)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (archive->type != SRCML_ARCHIVE_WRITE && archive->type != SRCML_ARCHIVE_RW)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    struct parsed_unit {
+        std::unique_ptr<srcml_unit> unit;
+        int status = SRCML_STATUS_OK;
+        bool done = false;
+    };
+    std::vector<parsed_unit> parsed(count);
+
+    // files are parsed only a few ahead of the writing, to bound the units in memory
+    const size_t max_ahead = 4 * (size_t) threads;
+    size_t next = 0;
+    size_t written = 0;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    auto work = [&]() {
+
+        while (true) {
+
+            size_t pos;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return next >= count || next < written + max_ahead; });
+                if (next >= count)
+                    return;
+
+                pos = next++;
+            }
+
+            std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
+            int status = src_filenames[pos] ? SRCML_STATUS_OK : SRCML_STATUS_INVALID_ARGUMENT;
+            if (status == SRCML_STATUS_OK)
+                status = unit ? srcml_unit_set_filename(unit.get(), src_filenames[pos]) : SRCML_STATUS_ERROR;
+            if (status == SRCML_STATUS_OK)
+                status = srcml_unit_parse_filename(unit.get(), src_filenames[pos]);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                parsed[pos].unit = std::move(unit);
+                parsed[pos].status = status;
+                parsed[pos].done = true;
+            }
+            cond.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+
+        for (size_t i = 0; i < (size_t) threads && i < count; ++i)
+            workers.emplace_back(work);
+
+    } catch (...) {
+
+        // stop the workers that started, with no file written
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            next = count;
+        }
+        cond.notify_all();
+
+        for (auto& worker : workers)
+            worker.join();
+
+        return SRCML_STATUS_ERROR;
+    }
+
+    int first_status = SRCML_STATUS_OK;
+    for (size_t pos = 0; pos < count; ++pos) {
+
+        parsed_unit result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return parsed[pos].done; });
+            result = std::move(parsed[pos]);
+        }
+
+        if (result.status == SRCML_STATUS_OK)
+            result.status = srcml_archive_write_unit(archive, result.unit.get());
+
+        if (callback)
+            callback(context, pos, result.status, result.status == SRCML_STATUS_OK ? result.unit.get() : nullptr);
+
+        if (first_status == SRCML_STATUS_OK)
+            first_status = result.status;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++written;
+        }
+        cond.notify_all();
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    return first_status;
+}
+
 /**
  * srcml_archive_write
  * @param archive a srcml archive opened for writing
@@ -1349,6 +1505,19 @@ struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* archive) {
     if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
         return nullptr;
 
+    if (archive->parallel_reader) {
+        srcml_unit* unit = nullptr;
+        const int status = archive->parallel_reader->read(unit);
+        if (status != SRCML_STATUS_OK) {
+            archive->error_number = status;
+            archive->error_string = "Unable to read the units of the archive";
+            return nullptr;
+        }
+        if (unit)
+            unit->position = ++archive->units_read;
+        return unit;
+    }
+
     std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
     int not_done = 0;
     if (!unit->read_header)
@@ -1359,6 +1528,7 @@ struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* archive) {
     if (!not_done || !unit->read_body) {
         return nullptr;
     }
+    unit->position = ++archive->units_read;
 
     return unit.release();
 }
@@ -1380,6 +1550,20 @@ int srcml_archive_skip_unit(struct srcml_archive* archive) {
     if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
         return 0;
 
+    if (archive->parallel_reader) {
+        srcml_unit* unit = nullptr;
+        const int status = archive->parallel_reader->read(unit);
+        if (status != SRCML_STATUS_OK) {
+            archive->error_number = status;
+            archive->error_string = "Unable to read the units of the archive";
+            return 0;
+        }
+        if (!std::unique_ptr<srcml_unit>(unit))
+            return 0;
+        ++archive->units_read;
+        return 1;
+    }
+
     // read the header only of a temporary unit
     std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
 
@@ -1387,10 +1571,431 @@ int srcml_archive_skip_unit(struct srcml_archive* archive) {
     if (!not_done) {
         return 0;
     }
+    ++archive->units_read;
 
     return 1;
 }
 
+/******************************************************************************
+ *                                                                            *
+ *                       Archive random access functions                      *
+ *                                                                            *
+ ******************************************************************************/
+
+// size, modification time in nanoseconds, and file serial number of an archive file
+struct srcml_archive_file_stat {
+    size_t size = 0;
+    std::int64_t mtime = 0;
+    std::uint64_t inode = 0;
+};
+
+/**
+ * srcml_archive_stat
+ * @param filename name of the archive file
+ *
+ * @returns the size, modification time, and file serial number of the file, or std::nullopt on failure
+ */
+static std::optional<srcml_archive_file_stat> srcml_archive_stat(const std::string& filename) {
+
+    srcml_archive_file_stat file;
+#ifndef _WIN32
+    struct stat st;
+    if (stat(filename.data(), &st) != 0)
+        return std::nullopt;
+#ifdef __APPLE__
+    file.mtime = (std::int64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    file.mtime = (std::int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    file.inode = (std::uint64_t) st.st_ino;
+#else
+    struct _stat64 st;
+    if (_stat64(filename.data(), &st) != 0)
+        return std::nullopt;
+    file.mtime = (std::int64_t) st.st_mtime * 1000000000;
+#endif
+    file.size = (size_t) st.st_size;
+
+    return file;
+}
+
+/**
+ * srcml_archive_index_current
+ * @param file the archive file
+ * @param size size of the indexed archive
+ * @param mtime modification time of the indexed archive
+ * @param inode file serial number of the indexed archive
+ *
+ * Only the file metadata is compared, so the check does not read the archive.
+ * A unit read with an index is also checked that it is at the indexed position.
+ *
+ * @returns if the file is the indexed archive, by its size, modification time, and file serial number
+ */
+static bool srcml_archive_index_current(const std::optional<srcml_archive_file_stat>& file, size_t size, std::int64_t mtime, std::uint64_t inode) {
+
+    return file && file->size == size && file->mtime == mtime && file->inode == inode;
+}
+
+/**
+ * srcml_archive_load_index
+ * @param archive a srcml archive open for reading
+ * @param rebuild build the index by a scan of the archive, even if there is a current sidecar index
+ *
+ * Load the unit index of the archive on first use. For a file, a
+ * sidecar index is used if it is for a file of the same size,
+ * modification time, and file serial number. Otherwise, the index
+ * is built by a scan of the archive.
+ *
+ * @returns the unit index, or nullptr if the archive cannot be indexed
+ */
+static const unit_index* srcml_archive_load_index(struct srcml_archive* archive, bool rebuild = false) {
+
+    if (archive->index && !rebuild)
+        return archive->index.get();
+
+    std::optional<unit_index> index;
+    if (archive->source_filename) {
+
+        // metadata before the scan, so a change during the scan makes the index stale
+        const auto file = srcml_archive_stat(*archive->source_filename);
+
+        if (!rebuild)
+            index = unit_index_read(unit_index_filename(*archive->source_filename).data());
+        if (!index || !srcml_archive_index_current(file, index->size, index->mtime, index->inode)) {
+
+            std::ifstream in(*archive->source_filename, std::ios::binary);
+            if (!in)
+                return nullptr;
+
+            index = unit_index_build([&in](char* buffer, size_t len) {
+                in.read(buffer, (std::streamsize) len);
+                return (size_t) in.gcount();
+            });
+            if (index && file) {
+                index->mtime = file->mtime;
+                index->inode = file->inode;
+            }
+        }
+
+    } else if (archive->source_memory.data()) {
+
+        std::string_view remaining = archive->source_memory;
+        index = unit_index_build([&remaining](char* buffer, size_t len) {
+            const size_t count = remaining.copy(buffer, len);
+            remaining.remove_prefix(count);
+            return count;
+        });
+    }
+
+    if (!index)
+        return nullptr;
+
+    archive->index = std::make_shared<unit_index>(std::move(*index));
+
+    return archive->index.get();
+}
+
+/**
+ * srcml_archive_read_source
+ * @param archive a srcml archive open for reading
+ * @param offset byte offset in the archive
+ * @param length number of bytes
+ * @param s string to append the bytes to
+ *
+ * @returns true on success, false on failure
+ */
+static bool srcml_archive_read_source(const struct srcml_archive* archive, size_t offset, size_t length, std::string& s) {
+
+    if (archive->source_memory.data()) {
+
+        if (offset + length > archive->source_memory.size())
+            return false;
+
+        s += archive->source_memory.substr(offset, length);
+
+        return true;
+    }
+
+    std::ifstream in(*archive->source_filename, std::ios::binary);
+    if (!in.seekg((std::streamoff) offset))
+        return false;
+
+    const size_t start = s.size();
+    s.resize(start + length);
+    in.read(s.data() + start, (std::streamsize) length);
+
+    return (size_t) in.gcount() == length;
+}
+
+/**
+ * srcml_archive_read_indexed_unit
+ * @param archive a srcml archive open for reading
+ * @param index the unit index of the archive
+ * @param pos position of the unit, starting at 1
+ * @param srcml string to append the root start tag, unit, and root end tag to
+ *
+ * The unit is checked that it starts with a unit start tag and ends with its
+ * end tag, as an archive changed in place may have the same size and
+ * modification time as the indexed archive.
+ *
+ * @returns true on success, false on failure or if the unit is not at the indexed position
+ */
+static bool srcml_archive_read_indexed_unit(const struct srcml_archive* archive, const unit_index& index, size_t pos, std::string& srcml) {
+
+    // the root start tag provides the namespaces and attributes of the archive
+    const auto& entry = index.units[pos - 1];
+    srcml.reserve(index.header_length + entry.length + index.footer.size());
+    if (!srcml_archive_read_source(archive, 0, index.header_length, srcml) ||
+        !srcml_archive_read_source(archive, entry.offset, entry.length, srcml))
+        return false;
+
+    // unit start tag, with any prefix
+    const std::string_view unit = std::string_view(srcml).substr(index.header_length);
+    const auto name_end = unit.find_first_of(" \t\r\n/>");
+    if (unit.empty() || unit.front() != '<' || name_end == std::string_view::npos)
+        return false;
+    const std::string_view name = unit.substr(1, name_end - 1);
+    if (name != "unit" && (name.size() <= 5 || name.substr(name.size() - 5) != ":unit"))
+        return false;
+
+    // unit end tag, or an empty unit
+    const std::string end_tag = "</" + std::string(name) + ">";
+    const bool ends = unit.size() >= end_tag.size() && unit.substr(unit.size() - end_tag.size()) == end_tag;
+    const bool empty = unit.find('>') == unit.size() - 1 && unit.substr(unit.size() - 2) == "/>";
+    if (!ends && !empty)
+        return false;
+
+    srcml += index.footer;
+
+    return true;
+}
+
+/**
+ * srcml_archive_read_unit_at
+ * @param archive a srcml archive open for reading
+ * @param pos position of the unit, starting at 1
+ *
+ * Read the unit at a position in the archive without reading the
+ * preceding units. Only the root start tag and the unit itself are
+ * read. The position of srcml_archive_read_unit() does not change.
+ *
+ * @returns Return the read srcml_unit on success.
+ * On failure, or if the archive cannot be indexed, returns NULL.
+ */
+struct srcml_unit* srcml_archive_read_unit_at(struct srcml_archive* archive, size_t pos) {
+
+    if (archive == nullptr || pos == 0)
+        return nullptr;
+
+    if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
+        return nullptr;
+
+    const unit_index* index = srcml_archive_load_index(archive);
+    if (!index || pos > index->units.size())
+        return nullptr;
+
+    std::string srcml;
+    if (!srcml_archive_read_indexed_unit(archive, *index, pos, srcml)) {
+
+        // a stale index of an archive file, so index it again
+        if (!archive->source_filename)
+            return nullptr;
+
+        index = srcml_archive_load_index(archive, true);
+        srcml.clear();
+        if (!index || pos > index->units.size() || !srcml_archive_read_indexed_unit(archive, *index, pos, srcml))
+            return nullptr;
+    }
+
+    // read the unit with a separate reader, but as a unit of this archive
+    std::unique_ptr<srcml_archive> reader(srcml_archive_create());
+    if (!reader)
+        return nullptr;
+    reader->encoding = archive->encoding;
+    reader->revision_number = archive->revision_number;
+
+    if (srcml_archive_read_open_memory(reader.get(), srcml.data(), srcml.size()) != SRCML_STATUS_OK)
+        return nullptr;
+
+    srcml_unit* unit = srcml_archive_read_unit(reader.get());
+    if (unit) {
+        unit->archive = archive;
+        unit->position = pos;
+    }
+
+    return unit;
+}
+
+/**
+ * srcml_archive_read_unit_by_filename
+ * @param archive a srcml archive open for reading
+ * @param filename the filename attribute of the unit
+ *
+ * Read the first unit with the filename without reading the other units.
+ * The position of srcml_archive_read_unit() does not change.
+ *
+ * @returns Return the read srcml_unit on success.
+ * If not found, on failure, or if the archive cannot be indexed, returns NULL.
+ */
+struct srcml_unit* srcml_archive_read_unit_by_filename(struct srcml_archive* archive, const char* filename) {
+
+    if (archive == nullptr || filename == nullptr)
+        return nullptr;
+
+    if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
+        return nullptr;
+
+    const unit_index* index = srcml_archive_load_index(archive);
+    if (!index)
+        return nullptr;
+
+    for (size_t pos = 0; pos < index->units.size(); ++pos) {
+        if (index->units[pos].filename == filename)
+            return srcml_archive_read_unit_at(archive, pos + 1);
+    }
+
+    return nullptr;
+}
+
+/**
+ * srcml_archive_write_index
+ * @param archive a srcml archive opened for reading with srcml_archive_read_open_filename()
+ *
+ * Write the sidecar index file for the archive file, the filename
+ * with the extension ".idx" appended. A current sidecar index file is
+ * used by srcml_archive_read_unit_at() instead of a scan of the archive.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_write_index(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if ((archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW) || !archive->source_filename)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    const unit_index* index = srcml_archive_load_index(archive);
+    if (!index)
+        return SRCML_STATUS_IO_ERROR;
+
+    if (!unit_index_write(*index, unit_index_filename(*archive->source_filename).data()))
+        return SRCML_STATUS_IO_ERROR;
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_write_term_index
+ * @param archive a srcml archive opened for reading with srcml_archive_read_open_filename()
+ *
+ * Write the sidecar term index file for the archive file, the filename
+ * with the extension ".tidx" appended. The term index is built by a scan
+ * of the archive, and records the units that contain each element name,
+ * text of a src:name element, and attribute value.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_write_term_index(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if ((archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW) || !archive->source_filename)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    // metadata before the scan, so a change during the scan makes the index stale
+    const auto file = srcml_archive_stat(*archive->source_filename);
+    std::ifstream in(*archive->source_filename, std::ios::binary);
+    if (!file || !in)
+        return SRCML_STATUS_IO_ERROR;
+
+    unit_term_index terms;
+    auto index = unit_index_build([&in](char* buffer, size_t len) {
+        in.read(buffer, (std::streamsize) len);
+        return (size_t) in.gcount();
+    }, &terms);
+    if (!index || terms.units != index->units.size())
+        return SRCML_STATUS_IO_ERROR;
+    terms.mtime = index->mtime = file->mtime;
+    terms.inode = index->inode = file->inode;
+
+    if (!archive->index)
+        archive->index = std::make_shared<unit_index>(std::move(*index));
+
+    if (!unit_term_index_write(terms, unit_term_index_filename(*archive->source_filename).data()))
+        return SRCML_STATUS_IO_ERROR;
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_read_term_index
+ * @param archive a srcml archive opened for reading with srcml_archive_read_open_filename()
+ *
+ * Read the sidecar term index file of the archive file if it is for a
+ * file of the same size, modification time, and file serial number.
+ * Transformations of the units read from the archive then skip any unit
+ * that does not contain the terms of a query.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_read_term_index(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if ((archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW) || !archive->source_filename)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    auto terms = unit_term_index_read(unit_term_index_filename(*archive->source_filename).data());
+    if (!terms || !srcml_archive_index_current(srcml_archive_stat(*archive->source_filename), terms->size, terms->mtime, terms->inode))
+        return SRCML_STATUS_IO_ERROR;
+
+    archive->term_index = std::make_shared<unit_term_index>(std::move(*terms));
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_enable_parallel_read
+ * @param archive a srcml archive opened for reading from a filename or memory
+ * @param threads number of parsing threads
+ *
+ * Read the units of the archive on worker threads. The archive is split
+ * into chunks at the unit boundaries of the unit index, and each chunk
+ * is parsed separately. srcml_archive_read_unit() and srcml_archive_skip_unit()
+ * deliver the units in order, starting with the first unit of the archive.
+ * Call before the first unit is read. The units stop at a chunk that cannot
+ * be parsed, with the status in the archive error.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_enable_parallel_read(struct srcml_archive* archive, int threads) {
+
+    if (archive == nullptr || threads < 1)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if ((archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW) || archive->parallel_reader)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    // a solitary unit cannot be split
+    const unit_index* index = srcml_archive_load_index(archive);
+    if (!index || index->footer.empty())
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    try {
+
+        archive->parallel_reader = new srcml_parallel_reader(archive, archive->index, threads);
+
+    } catch(...) {
+
+        return SRCML_STATUS_IO_ERROR;
+    }
+
+    return SRCML_STATUS_OK;
+}
+
 /******************************************************************************
  *                                                                            *
  *                       Archive close function                               *
@@ -1432,5 +2037,12 @@ void srcml_archive_close(struct srcml_archive* archive) {
         (*archive->buffer) = (char *) xmlBufferDetach(archive->xbuffer);
     }
 
+    delete archive->parallel_reader;
+    archive->parallel_reader = nullptr;
+
+    archive->source_filename.reset();
+    archive->source_memory = std::string_view();
+    archive->index.reset();
+
     archive->type = SRCML_ARCHIVE_INVALID;
 }
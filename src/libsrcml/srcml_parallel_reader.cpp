@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file srcml_parallel_reader.cpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ */
+
+#include <srcml_parallel_reader.hpp>
+#include <srcml.h>
+
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// target size in bytes of the srcML of a chunk
+static const size_t CHUNK_SIZE = 1024 * 1024;
+
+/**
+ * srcml_parallel_reader
+ * @param archive a srcml archive open for reading from a filename or memory
+ * @param index the unit index of the archive
+ * @param threads number of parsing threads
+ *
+ * Split the archive into chunks, and start parsing them.
+ * The file of an archive is mapped, or read if it cannot be mapped.
+ */
+srcml_parallel_reader::srcml_parallel_reader(srcml_archive* archive, std::shared_ptr<unit_index> index, int threads)
+    : archive(archive), index(std::move(index)), max_ahead(2 * (size_t) threads) {
+
+    if (archive->source_memory.data()) {
+
+        source = archive->source_memory;
+
+    } else {
+
+#ifndef _WIN32
+        int fd = open(archive->source_filename->data(), O_RDONLY);
+        struct stat st;
+        if (fd != -1 && fstat(fd, &st) == 0 && st.st_size > 0) {
+            mapping = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                source = std::string_view((const char*) mapping, (size_t) st.st_size);
+            } else {
+                mapping = nullptr;
+            }
+        }
+        if (fd != -1)
+            close(fd);
+#endif
+
+        if (!mapping) {
+            std::ifstream in(*archive->source_filename, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            source = contents;
+        }
+    }
+
+    if (source.size() != this->index->size) {
+        shutdown();
+        throw std::runtime_error("stale unit index");
+    }
+
+    // consecutive units up to the chunk size, with at least one unit
+    const auto& units = this->index->units;
+    for (size_t pos = 0; pos < units.size(); ) {
+
+        chunk part;
+        part.first = pos;
+        size_t size = 0;
+        do {
+            size += units[pos].length;
+            ++pos;
+        } while (pos < units.size() && size + units[pos].length <= CHUNK_SIZE);
+        part.last = pos - 1;
+
+        chunks.push_back(std::move(part));
+    }
+
+    // any started workers are stopped if another cannot be started
+    try {
+
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back(&srcml_parallel_reader::work, this);
+
+    } catch(...) {
+
+        shutdown();
+        throw;
+    }
+}
+
+/**
+ * ~srcml_parallel_reader
+ *
+ * Stop parsing, and release the source.
+ */
+srcml_parallel_reader::~srcml_parallel_reader() {
+
+    shutdown();
+}
+
+/**
+ * shutdown
+ *
+ * Stop and join the workers, and release the source.
+ */
+void srcml_parallel_reader::shutdown() {
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cond.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+
+#ifndef _WIN32
+    if (mapping)
+        munmap(mapping, source.size());
+    mapping = nullptr;
+#endif
+}
+
+/**
+ * work
+ *
+ * Parse the next chunk, as long as it is not too far ahead of the reader.
+ */
+void srcml_parallel_reader::work() {
+
+    while (true) {
+
+        size_t pos;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() { return stop || next_chunk >= chunks.size() || next_chunk < current + max_ahead; });
+            if (stop || next_chunk >= chunks.size())
+                return;
+
+            pos = next_chunk++;
+        }
+
+        chunk part;
+        part.first = chunks[pos].first;
+        part.last = chunks[pos].last;
+        parse(part);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunks[pos].units = std::move(part.units);
+            chunks[pos].status = part.status;
+            chunks[pos].parsed = true;
+        }
+        cond.notify_all();
+    }
+}
+
+/**
+ * parse
+ * @param part chunk of units to parse
+ *
+ * Parse the units of the chunk with a separate reader, but as units
+ * of the archive. The root start tag and end tag surround the units.
+ * The chunk fails if it does not have all of its units from the index.
+ */
+void srcml_parallel_reader::parse(chunk& part) const {
+
+    const auto& first = index->units[part.first];
+    const auto& last = index->units[part.last];
+
+    std::string srcml;
+    srcml.reserve(index->header_length + (last.offset + last.length - first.offset) + index->footer.size());
+    srcml += source.substr(0, index->header_length);
+    srcml += source.substr(first.offset, last.offset + last.length - first.offset);
+    srcml += index->footer;
+
+    std::unique_ptr<srcml_archive> reader(srcml_archive_create());
+    if (!reader) {
+        part.status = SRCML_STATUS_ERROR;
+        return;
+    }
+    reader->encoding = archive->encoding;
+    reader->revision_number = archive->revision_number;
+
+    part.status = srcml_archive_read_open_memory(reader.get(), srcml.data(), srcml.size());
+    if (part.status != SRCML_STATUS_OK)
+        return;
+
+    while (std::unique_ptr<srcml_unit> unit{ srcml_archive_read_unit(reader.get()) }) {
+        unit->archive = archive;
+        part.units.push_back(std::move(unit));
+    }
+
+    // malformed srcML ends the units early
+    if (part.units.size() != part.last - part.first + 1)
+        part.status = SRCML_STATUS_INVALID_INPUT;
+}
+
+/**
+ * read
+ * @param unit the next unit of the archive, or nullptr when done
+ *
+ * Wait for the chunk of the next unit to be parsed. The units of a
+ * failed chunk up to the failure are read, and then no others.
+ *
+ * @returns SRCML_STATUS_OK on success, and the status of a failed chunk otherwise
+ */
+int srcml_parallel_reader::read(srcml_unit*& unit) {
+
+    unit = nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (current < chunks.size()) {
+
+        cond.wait(lock, [this]() { return chunks[current].parsed; });
+
+        auto& part = chunks[current];
+        if (position < part.units.size()) {
+            unit = part.units[position++].release();
+            return SRCML_STATUS_OK;
+        }
+
+        if (part.status != SRCML_STATUS_OK)
+            return part.status;
+
+        // release the units of the chunk and let another chunk be parsed
+        part.units.clear();
+        part.units.shrink_to_fit();
+        ++current;
+        position = 0;
+        cond.notify_all();
+    }
+
+    return SRCML_STATUS_OK;
+}
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file srcml_parallel_reader.hpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * Parallel reading of the units of a srcML archive split at unit boundaries.
+ */
+
+#ifndef INCLUDED_SRCML_PARALLEL_READER_HPP
+#define INCLUDED_SRCML_PARALLEL_READER_HPP
+
+#include <srcml_types.hpp>
+#include <unit_index.hpp>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * srcml_parallel_reader
+ *
+ * Reads the units of an indexed srcML archive on worker threads.
+ * The archive is split into chunks of consecutive units at the unit
+ * boundaries of the index. Each chunk is parsed by a separate reader,
+ * with the root start tag of the archive before it for the namespaces
+ * and attributes. Units are delivered in archive order, and only a few
+ * chunks are parsed ahead of the reader.
+ */
+class srcml_parallel_reader {
+
+public :
+
+    srcml_parallel_reader(srcml_archive* archive, std::shared_ptr<unit_index> index, int threads);
+
+    ~srcml_parallel_reader();
+
+    // the next unit of the archive, or nullptr when done, with the status of its chunk
+    int read(srcml_unit*& unit);
+
+private :
+
+    // consecutive units parsed together
+    struct chunk {
+        size_t first = 0;
+        size_t last = 0;
+        bool parsed = false;
+        int status = SRCML_STATUS_OK;
+        std::vector<std::unique_ptr<srcml_unit>> units;
+    };
+
+    void work();
+
+    void shutdown();
+
+    void parse(chunk& part) const;
+
+    srcml_archive* archive;
+    std::shared_ptr<unit_index> index;
+
+    /** srcML of the archive, in memory or mapped from the file */
+    std::string_view source;
+    void* mapping = nullptr;
+    std::string contents;
+
+    std::vector<chunk> chunks;
+
+    /** next chunk to parse */
+    size_t next_chunk = 0;
+
+    /** chunk and unit position of the next unit to deliver */
+    size_t current = 0;
+    size_t position = 0;
+
+    /** number of chunks parsed ahead of the current chunk */
+    size_t max_ahead;
+
+    bool stop = false;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::thread> workers;
+};
+
+#endif
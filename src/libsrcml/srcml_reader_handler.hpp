@@ -24,9 +24,7 @@
 #include <string_view>
 #include <vector>
 #include <stack>
-
-#include <mutex>
-#include <condition_variable>
+#include <deque>
 #include <optional>
 
 using namespace ::std::literals::string_view_literals;
@@ -59,47 +57,44 @@ struct attribute_t {
     std::optional<std::string> value;
 };
 
+/**
+ * pending_unit
+ *
+ * Unit parsed ahead of the reader. The parser runs
+ * a chunk at a time, so it may start, and finish,
+ * units before the reader asks for them.
+ */
+struct pending_unit {
+
+    /** attributes, namespaces, and collected srcML of the unit */
+    srcml_unit unit;
+
+    /** header was given to the reader */
+    bool read_header = false;
+
+    /** end of the unit was parsed */
+    bool ended = false;
+};
+
 /**
  * srcml_reader_handler
  *
  * Inherits from srcMLHandler to provide hooks into
- * SAX2 parsing. Provides starting and stoping using
- * threads.  Collects attributes, namespaces and srcML
- * from units.
+ * SAX2 parsing. Collects attributes, namespaces and srcML
+ * from units into a queue of pending units for the reader.
  */
 class srcml_reader_handler : public srcSAXHandler {
 
 private :
 
-    /** mutex to halt both threads on */
-    std::mutex mutex;
-
-    /** sax stop/start condition */
-    std::condition_variable cond;
-
     /** collected root language */
     srcml_archive* archive = nullptr;
 
-    /** collected unit language */
-    srcml_unit* unit = nullptr;
+    /** units parsed, or being parsed, that the reader has not finished with */
+    std::deque<pending_unit> units;
 
     /** has reached end of parsing*/
     bool is_done = false;
-    /** has passed root*/
-    bool read_root = false;
-    /** stop after collecting unit attribute*/
-    bool collect_unit_header = false;
-    /** collect srcML as parse*/
-    bool collect_unit_body = false;
-
-    /** terminate */
-    bool terminate = false;
-
-    /** indicate if we need to wait on the root */
-    bool wait_root = true;
-
-    /** skip internal unit elements */
-    bool skip = false;
 
 public :
 
@@ -117,66 +112,11 @@ public :
     /**
      * ~srcml_reader_handler
      *
-     * Destructor, deletes mutex and conditions.
+     * Destructor
      */
     virtual ~srcml_reader_handler() {
      }
 
-    /**
-     * stop_parser
-     *
-     * Stop the parser for threading
-     */
-    void stop_parser() {
-
-        is_done = true;
-        srcSAXHandler::stop_parser();
-    }
-
-    /**
-     * wait
-     *
-     * Allows calling thread to wait until reached
-     * end of unit.
-     */
-    void wait() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-
-        if (is_done)
-            return;
-
-        if (wait_root)
-            cond.wait(lock);
-    }
-
-    /**
-     * resume
-     *
-     * Resume SAX2 execution.
-     */
-    void resume() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-
-        cond.notify_one();
-    }
-
-    /**
-     * resume_and_wait
-     *
-     * Atomic resume SAX2 execution then wait.
-     */
-    void resume_and_wait() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-        cond.notify_one();
-        if (is_done)
-            return;
-
-        cond.wait(lock);
-    }
-
     /**
      * done
      *
@@ -185,25 +125,20 @@ public :
     void done() {
 
         is_done = true;
-
-        cond.notify_one();
     }
 
     /**
-     * stop
+     * skip_unit
      *
-     * Stops SAX2 parsing Completely.  Parsing
-     * Can not be restarted.
+     * Discard the front unit. If the unit is still being parsed,
+     * the rest of its body is not collected.
      */
-    void stop() {
-
-        {
-            std::unique_lock<std::mutex> lock(mutex);
+    void skip_unit() {
 
-            terminate = true;
-        }
+        if (!units.front().ended)
+            skip_unit_body(get_controller().getContext()->libxml2_context);
 
-        resume();
+        units.pop_front();
     }
 
 #pragma GCC diagnostic push
@@ -323,8 +258,8 @@ public :
      * @param num_attributes the number of attributes on the tag
      * @param attributes list of attributes
      *
-     * Overidden startUnit to handle collection of Unit attributes and tag. Stop before continue
-     * if collecting attributes.
+     * Overidden startUnit to handle collection of Unit attributes and tag into
+     * a new pending unit.
      */
     virtual void startUnit(const char* /* localname */, const char* /* prefix */, const char* /* URI */,
                            int num_namespaces, const xmlChar** namespaces, int num_attributes,
@@ -334,49 +269,20 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
-        // pause
-        if (!read_root) {
-
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-
-                if (terminate)
-                    stop_parser();
-                wait_root = false;
-                cond.notify_one();
-                cond.wait(lock);
-                read_root = true;
-            }
-
-            if (terminate) {
-
-                stop_parser();
-                return;
-            }
-        }
+        units.emplace_back();
+        srcml_unit* unit = &units.back().unit;
+        unit->archive = archive;
 
         // collect attributes
         unit_update_attributes(unit, num_attributes, attributes);
 
+        // the reader decides on the body after this unit is parsed, so always collect
         auto ctxt = (xmlParserCtxtPtr) get_controller().getContext()->libxml2_context;
         auto state = (sax2_srcsax_handler*) ctxt->_private;
 
-        state->collect_unit_body = collect_unit_body;
-
-        if (collect_unit_header) {
-
-            // pause
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate)
-                stop_parser();
-
-            cond.notify_one();
-            cond.wait(lock);
-        }
-
         state->loc = 0;
 
-        state->collect_unit_body = collect_unit_body;
+        state->collect_unit_body = true;
 
         // collect namespaces
         for (int pos = 0; pos < num_namespaces; ++pos) {
@@ -389,9 +295,6 @@ public :
             srcml_unit_register_namespace(unit, nsPrefix.data(), nsURI.data());
         }
 
-        if (terminate)
-            stop_parser();
-
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
@@ -403,8 +306,7 @@ public :
      * @param prefix prefix for the tag
      * @param URI uri for tag
      *
-     * Overidden endRoot to indicate done with parsing and
-        free any waiting process.
+     * Overidden endRoot to indicate done with parsing.
      */
     virtual void endRoot(const char* /* localname */, const char* /* prefix */, const char* /* URI */) {
 
@@ -412,16 +314,7 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
-        {
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate)
-                stop_parser();
-            is_done = true;
-            cond.notify_one();
-        }
-
-        if (terminate)
-            stop_parser();
+        is_done = true;
 
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -434,7 +327,7 @@ public :
      * @param prefix prefix for the tag
      * @param URI uri for tag
      *
-     * Overidden endUnit to collect srcml and stop parsing.  Clear collect srcML after pause.
+     * Overidden endUnit to collect srcml into the pending unit.
      */
     virtual void endUnit(const char* /* localname */, const char* /* prefix */, const char* /* URI */) {
 
@@ -442,49 +335,44 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
+        // unit was skipped by the reader before its end
+        if (units.empty() || units.back().ended)
+            return;
+
         auto ctxt = (xmlParserCtxtPtr) get_controller().getContext()->libxml2_context;
         auto state = (sax2_srcsax_handler*) ctxt->_private;
 
-        if (collect_unit_body) {
-
-            if (!state->unitsrc.empty() && state->unitsrc.back() != '\n')
-                ++state->loc;
+        units.back().ended = true;
+        srcml_unit* unit = &units.back().unit;
 
-            unit->content_begin = state->content_begin;
-            unit->content_end = state->content_end;
-            unit->insert_begin = state->insert_begin;
-            unit->insert_end = state->insert_end;
-            unit->srcml = std::move(state->unitsrcml);
-            unit->src = std::move(state->unitsrc);
-            unit->loc = state->loc;
+        if (!state->unitsrc.empty() && state->unitsrc.back() != '\n')
+            ++state->loc;
 
-            // update provisional cpp prefix
-            if (state->cpp_prefix) {
+        unit->content_begin = state->content_begin;
+        unit->content_end = state->content_end;
+        unit->insert_begin = state->insert_begin;
+        unit->insert_end = state->insert_end;
+        unit->srcml = std::move(state->unitsrcml);
+        unit->src = std::move(state->unitsrc);
+        unit->loc = state->loc;
 
-                // namespaces probably aren't create yet
-                if (!unit->namespaces) {
-                    unit->namespaces = starting_namespaces;
-                }
+        // update provisional cpp prefix
+        if (state->cpp_prefix) {
 
-                // set the found prefix, plus mark it as used
-                auto it = findNSURI(*unit->namespaces, SRCML_CPP_NS_URI);
-                if (it != unit->namespaces->end()) {
-                    it->flags |= NS_USED;
-                } else {
-                    unit->namespaces->emplace_back(state->cpp_prefix->data(), SRCML_CPP_NS_URI, NS_USED | NS_STANDARD);
-                }
+            // namespaces probably aren't create yet
+            if (!unit->namespaces) {
+                unit->namespaces = starting_namespaces;
             }
 
-            // pause
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate) stop_parser();
-            cond.notify_one();
-            cond.wait(lock);
+            // set the found prefix, plus mark it as used
+            auto it = findNSURI(*unit->namespaces, SRCML_CPP_NS_URI);
+            if (it != unit->namespaces->end()) {
+                it->flags |= NS_USED;
+            } else {
+                unit->namespaces->emplace_back(state->cpp_prefix->data(), SRCML_CPP_NS_URI, NS_USED | NS_STANDARD);
+            }
         }
 
-        if (terminate)
-            stop_parser();
-
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
@@ -9,33 +9,6 @@
 #include <stdlib.h>
 #include <iostream>
 
-/**
- * start_routine
- * @param arguments thread_args structure with control and handler
- *
- * Starts the parsing of the document.
- */
-static void* start_routine(thread_args* args) {
-
-    try {
-
-        args->control->parse(args->handler);
-
-    } catch(SAXError error) {
-
-        if (!(error.error_code == XML_ERR_EXTRA_CONTENT || error.error_code == XML_ERR_DOCUMENT_END)) {
-
-            fprintf(stderr, "Error Parsing: %s\n", error.message.data());
-
-            args->handler->done();
-        }
-
-        // might have to release a lock here or set is_done
-    }
-
-    return 0;
-}
-
 /**
  * srcml_sax2_reader
  * @param input parser input buffer
@@ -47,11 +20,9 @@ srcml_sax2_reader::srcml_sax2_reader(srcml_archive* archive, std::unique_ptr<xml
 
     handler.archive = archive;
 
-    // Setup thread here after things are created and settled
-    // Do not put in member initialization list as it can cause random crashes
-    thread = std::thread(start_routine, &args);
-
-    handler.wait();
+    // parse up to the first unit to collect the root attributes
+    while (handler.units.empty() && parse_next())
+        ;
 }
 
 /**
@@ -60,24 +31,41 @@ srcml_sax2_reader::srcml_sax2_reader(srcml_archive* archive, std::unique_ptr<xml
  * Destructor a srcml_sax2_reader
  */
 srcml_sax2_reader::~srcml_sax2_reader() {
+}
+
+/**
+ * parse_next
+ *
+ * Parse the next chunk of the srcML, collecting any units in it.
+ *
+ * @returns true if there is more to parse
+ */
+bool srcml_sax2_reader::parse_next() {
 
-    handler.stop();
+    if (handler.is_done)
+        return false;
+
+    try {
 
-    if (thread.joinable()) {
-        try {
-            thread.join();
-        } catch(const std::system_error& e) {
-            std::cerr << "srcml: Internal error " << e.code() << " meaning " << e.what() << '\n';
+        if (!control.parse_chunk(&handler))
+            handler.done();
+
+    } catch(SAXError error) {
+
+        if (!(error.error_code == XML_ERR_EXTRA_CONTENT || error.error_code == XML_ERR_DOCUMENT_END)) {
+
+            fprintf(stderr, "Error Parsing: %s\n", error.message.data());
         }
+
+        handler.done();
     }
+
+    return !handler.is_done;
 }
 
 /**
  * read_header
- * @param language a location to store the language attribute
- * @param filename a location to store the filename attribute
- * @param url a location to store the url attribute
- * @param version a location to store the version attribute
+ * @param unit the unit to store the attributes in
  *
  * Read attributes from next unit.
  *
@@ -85,23 +73,28 @@ srcml_sax2_reader::~srcml_sax2_reader() {
  */
 int srcml_sax2_reader::read_header(srcml_unit* unit) {
 
-    handler.unit = unit;
-
-    if (handler.is_done)
-        return 0;
+    // done with the previous unit, including any of its body not yet parsed
+    if (!handler.units.empty() && handler.units.front().read_header)
+        handler.skip_unit();
 
-    handler.skip = true;
-    handler.collect_unit_header = true;
-    handler.collect_unit_body = false;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
-    handler.collect_unit_header = false;
-    handler.skip = false;
+    while (handler.units.empty() && parse_next())
+        ;
 
-    if (handler.is_done)
+    if (handler.units.empty())
         return 0;
 
-    handler.unit = 0;
+    auto& pending = handler.units.front();
+    pending.read_header = true;
+
+    unit->revision = pending.unit.revision;
+    unit->language = pending.unit.language;
+    unit->filename = pending.unit.filename;
+    unit->url = pending.unit.url;
+    unit->version = pending.unit.version;
+    unit->timestamp = pending.unit.timestamp;
+    unit->hash = pending.unit.hash;
+    unit->attributes = pending.unit.attributes;
+    unit->namespaces = pending.unit.namespaces;
 
     unit->read_header = true;
 
@@ -110,63 +103,54 @@ int srcml_sax2_reader::read_header(srcml_unit* unit) {
 
 /**
  * read
- * @param language a location to store the language attribute
- * @param filename a location to store the filename attribute
- * @param url a location to store the url attribute
- * @param version a location to store the version attribute
+ * @param unit the unit to store the attributes and srcML in
  *
- * Read attributes from next unit.
+ * Read attributes and srcML from next unit.
  *
  * @returns 1 on success and 0 on failure.
  */
 int srcml_sax2_reader::read(srcml_unit* unit) {
 
-    handler.unit = unit;
-
-    if (handler.is_done)
+    if (!read_header(unit))
         return 0;
 
-    handler.skip = true;
-    handler.collect_unit_header = true;
-    handler.collect_unit_body = true;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
-    handler.collect_unit_header = false;
-    handler.skip = false;
-
-    if (handler.is_done)
-        return 0;
-
-    handler.unit = 0;
-
-    unit->read_header = true;
-    unit->read_body = true;
-
-    return 1;
+    return read_body(unit);
 }
 
 /**
  * read_body
- * @param output_buffer output buffer to write text
+ * @param unit the unit to store the srcML in
  *
- * Read the next unit from a srcML Archive
- * and return in the passed string parameter.
+ * Read the srcML of the unit from a srcML Archive. If the
+ * header was not read, the next unit is read.
  *
  * @returns 1 on success and 0 if done
  */
 int srcml_sax2_reader::read_body(srcml_unit* unit) {
 
-    if (handler.is_done)
+    if ((handler.units.empty() || !handler.units.front().read_header) && !read_header(unit))
         return 0;
 
-    handler.unit = unit;
-    handler.collect_unit_body = true;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
+    // parse until the end of the unit
+    while (!handler.units.front().ended && parse_next())
+        ;
 
-    if (handler.is_done)
+    auto& pending = handler.units.front();
+    if (!pending.ended)
         return 0;
 
+    unit->content_begin = pending.unit.content_begin;
+    unit->content_end = pending.unit.content_end;
+    unit->insert_begin = pending.unit.insert_begin;
+    unit->insert_end = pending.unit.insert_end;
+    unit->srcml = std::move(pending.unit.srcml);
+    unit_reset_srcml_parts(unit);
+    unit->src = std::move(pending.unit.src);
+    unit->loc = pending.unit.loc;
+    unit->namespaces = std::move(pending.unit.namespaces);
+
+    handler.units.pop_front();
+
     unit->read_body = true;
 
     return 1;
@@ -20,30 +20,16 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 #include <optional>
 
-/**
- * thread_args
- *
- * Structure to hold information to pass
- * to thread function.
- */
-struct thread_args {
-
-    /** control for sax processing */
-    srcSAXController* control = nullptr;
-
-    /** handler with hooks for sax processing */
-    srcml_reader_handler* handler = nullptr;
-};
-
 /**
  * srcml_sax2_reader
  *
  * Extend XML Text Reader interface to
  * progressively read a srcML Archive collecting
- * units and reading unit attributes.
+ * units and reading unit attributes. The srcML is
+ * parsed a chunk at a time on the calling thread,
+ * only as far as needed for the requested unit.
  */
 class srcml_sax2_reader {
 
@@ -57,9 +43,8 @@ public :
 
 private :
 
-    /** thread running execution */
-    std::thread thread;
-    thread_args args = { &control, &handler };
+    // parse the next chunk of the srcML
+    bool parse_next();
 
 public :
 
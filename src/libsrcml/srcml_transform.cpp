@@ -21,6 +21,9 @@
 
 #include <xsltTransformation.hpp>
 #include <xpathTransformation.hpp>
+#include <xpath_stream.hpp>
+#include <unit_index.hpp>
+#include <srcql.hpp>
 #include <relaxngTransformation.hpp>
 
 #include <libxml2_utilities.hpp>
@@ -33,6 +36,15 @@
 #include <optional>
 #include <iostream>
 
+/**
+ * Result node of a query, kept as srcML until a unit is requested
+ */
+struct result_node {
+    std::string srcml;
+    bool usesCpp = false;
+    bool usesOpenMP = false;
+};
+
 /**
  * Transformation result. Passed to srcml_unit_apply_transforms() to collect results of transformation
  */
@@ -41,6 +53,13 @@ struct srcml_transform_result {
     int type;
     /** Array of srcml units for type SRCML_RESULT_UNITS */
     std::vector<srcml_unit*> units;
+    /** Result nodes for type SRCML_RESULT_UNITS, before they are units */
+    std::vector<result_node> nodes;
+    /** Unit the result nodes are from, and the position of its item attribute */
+    srcml_unit* nodes_unit = nullptr;
+    std::size_t nodes_item = 0;
+    /** Result nodes are whole units, with their own start tags */
+    bool nodes_wrapped = false;
     /** Result for type SRCML_RESULT_BOOLEAN */
     std::optional<int> boolValue;
     /** Result for type SRCML_RESULT_NUMBER */
@@ -281,6 +300,27 @@ int srcml_append_transform_srcql_element(struct srcml_archive* archive, const ch
     return srcml_append_transform_srcql_internal(archive, srcql_string, prefix, namespace_uri, element, 0, 0, 0, 0);
 }
 
+/**
+ * srcml_set_srcql_cache
+ * @param cache_filename name of the cache file
+ *
+ * Use the file as a persistent cache of the conversions of srcQL queries to XPath.
+ * Conversions in the file for the current srcQL and srcML versions are used
+ * without converting the query again, and new conversions are added to the file.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+int srcml_set_srcql_cache(const char* cache_filename) {
+
+    if (cache_filename == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (!srcql_set_cache(cache_filename))
+        return SRCML_STATUS_INVALID_INPUT;
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * srcml_append_transform_xslt_internal
  * @param archive a srcml_archive
@@ -598,92 +638,221 @@ static bool usesURI(xmlNode* cur_node, std::string_view URI) {
 }
 
 /**
- * srcml_unit_apply_transforms
- * @param iarchive an input srcml archive
- * @param oarchive and output srcml archive
- *
- * Apply appended transformations inorder added and consecutively.
- * Intermediate results are stored in a temporary file.
- * Transformations are cleared.
+ * result_item
+ * @param unit the unit the transformation was applied to
+ * @param currentItemPosition position of the item attribute of the unit
+ * @param pos position of the result
+ * @param total number of results
  *
- * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ * @returns the item attribute of a partial result
  */
-int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit* unit, struct srcml_transform_result** presult) {
-    if (archive == nullptr || unit == nullptr)
-        return SRCML_STATUS_INVALID_ARGUMENT;
+static std::string result_item(const struct srcml_unit* unit, std::size_t currentItemPosition, int pos, int total) {
 
-    // unit stays the same for no transformation
-    if (archive->transformations.empty())
-        return SRCML_STATUS_OK;
+    if (currentItemPosition >= unit->attributes.size())
+        return std::to_string(pos + 1);
 
-    srcml_transform_result* result = nullptr;
-    if (presult) {
-        *presult = new srcml_transform_result;
-        result = *presult;
-        result->type = SRCML_RESULT_NONE;
-        result->boolValue = false;
+    auto item = unit->attributes[currentItemPosition].value;
+    if (total > 1) {
+        item += '-';
+        item += std::to_string(pos + 1);
     }
 
-    // find the position of the item attribute, if it exists
-    // the attribute array consists of { name1, value1, name2, value2, ... }
-    auto currentItemPosition = unit->attributes.size();
-    for (std::size_t i = 0; i < unit->attributes.size(); i += 2) {
-        if (unit->attributes[i].name == "item"sv) {
-            currentItemPosition = i;
-            break;
+    return item;
+}
+
+/**
+ * result_unit
+ * @param unit the unit the transformation was applied to
+ * @param currentItemPosition position of the item attribute of the unit
+ * @param pos position of the result
+ * @param total number of results
+ * @param unitWrapped if the result is a whole unit
+ *
+ * Create a unit for a result, with an item attribute for partial results.
+ * The cpp and openmp namespaces are unused until result_unit_uses().
+ *
+ * @returns the new unit
+ */
+static srcml_unit* result_unit(struct srcml_unit* unit, std::size_t currentItemPosition, int pos, int total, bool unitWrapped) {
+
+    auto nunit = srcml_unit_clone(unit);
+    nunit->read_body = nunit->read_header = true;
+    if (!unitWrapped) {
+
+        // remove the hash since not valid for partial query results
+        nunit->hash = std::nullopt;
+
+        // update or add item attribute
+        if (currentItemPosition < unit->attributes.size()) {
+            nunit->attributes[currentItemPosition].value = result_item(unit, currentItemPosition, pos, total);
+        } else {
+            nunit->attributes.push_back({"", "", "item", result_item(unit, currentItemPosition, pos, total)});
         }
     }
 
-    // create a DOM of the unit
+    // when no namespace, use the starting namespaces
+    if (!nunit->namespaces)
+        nunit->namespaces = starting_namespaces;
 
-    std::shared_ptr<xmlDoc> doc(xmlReadMemory(unit->srcml.data(), (int) unit->srcml.size(), 0, 0, XML_PARSE_HUGE), [](xmlDoc* doc) { xmlFreeDoc(doc); });
-    if (doc == nullptr)
-        return SRCML_STATUS_ERROR;
+    // mark unused cpp and omp until we examine the query result
+    auto itcpp = findNSURI(*nunit->namespaces, SRCML_CPP_NS_URI);
+    if (itcpp != nunit->namespaces->end()) {
+        itcpp->flags &= ~NS_USED;
+    }
+    auto itomp = findNSURI(*nunit->namespaces, SRCML_OPENMP_NS_URI);
+    if (itomp != nunit->namespaces->end()) {
+        itomp->flags &= ~NS_USED;
+    }
 
-    // apply transformations sequentially on the results from the previous transformation
-    std::unique_ptr<xmlNodeSet> fullresults(xmlXPathNodeSetCreate(xmlDocGetRootElement(doc.get())));
-    if (fullresults == nullptr)
-        return SRCML_STATUS_ERROR;
+    return nunit;
+}
 
-    // final result of all applied transformations
-    TransformationResult lastresult;
-    std::shared_ptr<xmlDoc> curdoc(doc);
-    for (const auto& trans : archive->transformations) {
-        // preserve the fullresults to iterate through
-        // collect results from this transformation applied to the potentially multiple
-        // results of the previous transformation step
-        std::unique_ptr<xmlNodeSet> pr(xmlXPathNodeSetCreate(0));
-        if (pr == nullptr)
-            return SRCML_STATUS_ERROR;
-        fullresults.swap(pr);
+/**
+ * result_unit_uses
+ * @param nunit a result unit
+ * @param prefix the default prefix of the namespace
+ * @param uri the namespace uri
+ *
+ * Mark the namespace as used by the result.
+ */
+static void result_unit_uses(struct srcml_unit* nunit, std::string_view prefix, std::string_view uri) {
 
-        for (int i = 0; i < pr->nodeNr; ++i) {
+    auto it = findNSURI(*nunit->namespaces, uri);
+    if (it != nunit->namespaces->end()) {
+        it->flags |= NS_USED;
+    } else {
+        nunit->namespaces->emplace_back(prefix, uri, NS_USED | NS_STANDARD);
+    }
+}
 
-            xmlDocSetRootElement(curdoc.get(), pr->nodeTab[i]);
+/**
+ * result_unit_start_tag
+ * @param nunit a result unit with the srcML of a whole unit
+ *
+ * Mark the inside of the unit, and update the unit attributes from its start tag.
+ */
+static void result_unit_start_tag(struct srcml_unit* nunit) {
+
+    // mark inside the units
+    nunit->content_begin = (int) nunit->srcml.find_first_of('>') + 1;
+    nunit->content_end =   (int) nunit->srcml.find_last_of('<') + 1;
+
+    // update the unit attributes with the transformed result based on the root tag
+    xmlSAXHandler roottagsax;
+    memset(&roottagsax, 0, sizeof(roottagsax));
+    roottagsax.initialized    = XML_SAX2_MAGIC;
+    roottagsax.startElementNs = [](void* ctx, const xmlChar* /* localname */, const xmlChar* /* prefix */, const xmlChar* /* URI */,
+                     int /* nb_namespaces */, const xmlChar** /* namespaces */,
+                     int nb_attributes, int /* nb_defaulted */, const xmlChar** attributes) {
+
+        auto ctxt = (xmlParserCtxtPtr) ctx;
+        if (ctxt == nullptr)
+            return;
+        auto unit = (srcml_unit*) ctxt->_private;
+        if (unit == nullptr)
+            return;
+
+        unit_update_attributes(unit, nb_attributes, attributes);
+    };
 
-            int language = srcml_check_language(srcml_unit_get_language(unit));
-            lastresult = trans->apply(curdoc.get(), language);
-            std::unique_ptr<xmlNodeSet> results(std::move(lastresult.nodeset));
-            if (results == nullptr) {
-                break;
-            }
+    // extract the start tag, turning it into an empty tag
+    // note: it may be an empty tag already
+    std::string starttag = nunit->srcml.substr(0, static_cast<std::size_t>(nunit->content_begin - 1));
+    if (starttag.back() != '/')
+        starttag += '/';
+    starttag += '>';
+
+    // parse the start tag updating the unit
+    xmlParserCtxtPtr context = xmlCreateMemoryParserCtxt(starttag.data(), (int) starttag.size());
+    auto save_private = context->_private;
+    context->_private = nunit;
+    auto save_sax = context->sax;
+    context->sax = &roottagsax;
+
+    // parse our single-element unit
+    xmlParseDocument(context);
+
+    // restore state and free
+    context->_private = save_private;
+    context->sax = save_sax;
+    xmlFreeParserCtxt(context);
+}
 
-            xmlXPathNodeSetMerge(fullresults.get(), results.get());
-        }
+/**
+ * result_nodes
+ * @param unit the unit the transformation was applied to
+ * @param currentItemPosition position of the item attribute of the unit
+ * @param unitWrapped if the result nodes are whole units
+ * @param result the transformation result to fill in
+ *
+ * Start a result of query nodes, which are units only when requested.
+ * Only called when there are nodes, since the unit is cloned.
+ */
+static void result_nodes(struct srcml_unit* unit, std::size_t currentItemPosition, bool unitWrapped, struct srcml_transform_result* result) {
 
-        // necessary to avoid access to free'd memory later on
-        // does NOT cause a memory leak
-        pr->nodeNr = 0;
+    result->type = SRCML_RESULT_UNITS;
+    result->nodes_unit = srcml_unit_clone(unit);
+    result->nodes_item = currentItemPosition;
+    result->nodes_wrapped = unitWrapped;
+}
 
-        // result of the transformation may be a new doc
-        if (lastresult.doc && lastresult.doc.get() != doc.get()) {
-            curdoc = lastresult.doc;
+/**
+ * result_node_units
+ * @param result a transformation result
+ *
+ * Create the units of the result nodes.
+ */
+static void result_node_units(struct srcml_transform_result* result) {
+
+    const int total = (int) result->nodes.size();
+    for (int i = 0; i < total; ++i) {
+        auto& node = result->nodes[(std::size_t) i];
+
+        auto nunit = result_unit(result->nodes_unit, result->nodes_item, i, total, result->nodes_wrapped);
+        nunit->srcml = std::move(node.srcml);
+
+        if (node.usesCpp)
+            result_unit_uses(nunit, SRCML_CPP_NS_DEFAULT_PREFIX, SRCML_CPP_NS_URI);
+        if (node.usesOpenMP)
+            result_unit_uses(nunit, SRCML_OPENMP_NS_DEFAULT_PREFIX, SRCML_OPENMP_NS_URI);
+
+        if (result->nodes_wrapped) {
+            result_unit_start_tag(nunit);
+        } else {
+            nunit->content_begin = 0;
+            nunit->content_end = (int) nunit->srcml.size() + 1;
         }
+        nunit->insert_begin = 0;
+        nunit->insert_end = 0;
 
-        // if there are no results, then we can't apply further transformations
-        // but there still might be results in the scalar values
-        if (fullresults->nodeNr == 0) {
-            result->units.clear();
+        result->units.push_back(nunit);
+    }
+
+    result->nodes.clear();
+}
+
+/**
+ * transform_result_units
+ * @param unit the unit the transformation was applied to
+ * @param lastresult the result of the last transformation
+ * @param fullresults the nodes of the results
+ * @param curdoc the doc of the result nodes
+ * @param result the transformation result to fill in
+ *
+ * Store the scalar value of the transformation result, or create
+ * units from the result nodes.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+static int transform_result_units(struct srcml_unit* unit, const TransformationResult& lastresult, xmlNodeSet* fullresults,
+                                  xmlDoc* curdoc, struct srcml_transform_result* result) {
+
+    // find the position of the item attribute, if it exists
+    // the attribute array consists of { name1, value1, name2, value2, ... }
+    auto currentItemPosition = unit->attributes.size();
+    for (std::size_t i = 0; i < unit->attributes.size(); i += 2) {
+        if (unit->attributes[i].name == "item"sv) {
+            currentItemPosition = i;
             break;
         }
     }
@@ -730,40 +899,14 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
     // create units out of the transformation results
     result->type = lastresult.nodeType;
 
-    for (int i = 0; i < fullresults->nodeNr; ++i) {
-
-        // create a new unit to store the results in
-        auto nunit = srcml_unit_clone(unit);
-        nunit->read_body = nunit->read_header = true;
-        if (!lastresult.unitWrapped) {
-
-            // remove the hash since not valid for partial query results
-            nunit->hash = std::nullopt;
-
-            // update or add item attribute
-            if (currentItemPosition < unit->attributes.size()) {
-                if (fullresults->nodeNr > 1) {
-                    nunit->attributes[currentItemPosition].value += '-';
-                    nunit->attributes[currentItemPosition].value += std::to_string(i + 1);
-                }
-            } else {
-                nunit->attributes.push_back({"", "", "item", std::to_string(i + 1)});
-            }
-        }
+    // query results, and whole unit results, are kept as srcML until a unit is requested
+    if (fullresults->nodeNr > 0)
+        result_nodes(unit, currentItemPosition, lastresult.unitWrapped, result);
 
-        // when no namespace, use the starting namespaces
-        if (!nunit->namespaces)
-            nunit->namespaces = starting_namespaces;
+    for (int i = 0; i < fullresults->nodeNr; ++i) {
 
-        // mark unused cpp and omp until we examine the query result
-        auto itcpp = findNSURI(*nunit->namespaces, SRCML_CPP_NS_URI);
-        if (itcpp != nunit->namespaces->end()) {
-            itcpp->flags &= ~NS_USED;
-        }
-        auto itomp = findNSURI(*nunit->namespaces, SRCML_OPENMP_NS_URI);
-        if (itomp != nunit->namespaces->end()) {
-            itomp->flags &= ~NS_USED;
-        }
+        result->nodes.emplace_back();
+        std::string& srcml = result->nodes.back().srcml;
 
         // special cases where the nodes are not written to the tree
 #ifdef _MSC_VER
@@ -774,24 +917,24 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
         case XML_COMMENT_NODE:
 
             for (auto c : "<!--"sv)
-                nunit->srcml += c;
-            nunit->srcml.append((const char*) fullresults->nodeTab[i]->content);
+                srcml += c;
+            srcml.append((const char*) fullresults->nodeTab[i]->content);
             for (auto c : "-->"sv)
-                nunit->srcml += c;
+                srcml += c;
             break;
 
         case XML_TEXT_NODE:
 
-            nunit->srcml.append((const char*) fullresults->nodeTab[i]->content);
+            srcml.append((const char*) fullresults->nodeTab[i]->content);
             break;
 
         case XML_ATTRIBUTE_NODE:
 
-            nunit->srcml.append((const char*) fullresults->nodeTab[i]->name);
-            nunit->srcml += '=';
-            nunit->srcml += '"';
-            nunit->srcml.append((const char*) fullresults->nodeTab[i]->children->content);
-            nunit->srcml += '"';
+            srcml.append((const char*) fullresults->nodeTab[i]->name);
+            srcml += '=';
+            srcml += '"';
+            srcml.append((const char*) fullresults->nodeTab[i]->children->content);
+            srcml += '"';
             break;
 
         default:
@@ -803,86 +946,19 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
 
                 return len;
 
-            }, 0, &(nunit->srcml), 0);
-            xmlNodeDumpOutput(output, curdoc.get(), fullresults->nodeTab[i], 0, 0, 0);
+            }, 0, &srcml, 0);
+            xmlNodeDumpOutput(output, curdoc, fullresults->nodeTab[i], 0, 0, 0);
 
             // very important to flush to make sure the unit contents are all present
             // also performs a free of resources
             xmlOutputBufferClose(output);
 
-            // update the cpp namespace if actually used
-            if (usesURI(fullresults->nodeTab[i], SRCML_CPP_NS_URI)) {
-
-                if (itcpp != nunit->namespaces->end()) {
-                    itcpp->flags |= NS_USED;
-                } else {
-                    nunit->namespaces->emplace_back(SRCML_CPP_NS_DEFAULT_PREFIX, SRCML_CPP_NS_URI, NS_USED | NS_STANDARD);
-                }
-            }
-
-            // update the openmp namespace if actually used
-            if (usesURI(fullresults->nodeTab[i], SRCML_OPENMP_NS_URI)) {
-
-                if (itomp != nunit->namespaces->end()) {
-                    itomp->flags |= NS_USED;
-                } else {
-                    nunit->namespaces->emplace_back(SRCML_OPENMP_NS_DEFAULT_PREFIX, SRCML_OPENMP_NS_URI, NS_USED | NS_STANDARD);
-                }
-            }
+            // update the cpp and openmp namespaces if actually used
+            result->nodes.back().usesCpp = usesURI(fullresults->nodeTab[i], SRCML_CPP_NS_URI);
+            result->nodes.back().usesOpenMP = usesURI(fullresults->nodeTab[i], SRCML_OPENMP_NS_URI);
 
             break;
         }
-
-        // mark inside the units
-        nunit->content_begin = lastresult.unitWrapped ? (int) nunit->srcml.find_first_of('>') + 1 : 0;
-        nunit->content_end =   lastresult.unitWrapped ? (int) nunit->srcml.find_last_of('<') + 1  : (int) nunit->srcml.size() + 1;
-        nunit->insert_begin = 0;
-        nunit->insert_end = 0;
-
-        // update the unit attributes with the transformed result based on the root tag
-        if (lastresult.unitWrapped) {
-            xmlSAXHandler roottagsax;
-            memset(&roottagsax, 0, sizeof(roottagsax));
-            roottagsax.initialized    = XML_SAX2_MAGIC;
-            roottagsax.startElementNs = [](void* ctx, const xmlChar* /* localname */, const xmlChar* /* prefix */, const xmlChar* /* URI */,
-                             int /* nb_namespaces */, const xmlChar** /* namespaces */,
-                             int nb_attributes, int /* nb_defaulted */, const xmlChar** attributes) {
-
-                auto ctxt = (xmlParserCtxtPtr) ctx;
-                if (ctxt == nullptr)
-                    return;
-                auto unit = (srcml_unit*) ctxt->_private;
-                if (unit == nullptr)
-                    return;
-
-                unit_update_attributes(unit, nb_attributes, attributes);
-            };
-
-            // extract the start tag, turning it into an empty tag
-            // note: it may be an empty tag already
-            std::string starttag = nunit->srcml.substr(0, static_cast<std::size_t>(nunit->content_begin - 1));
-            if (starttag.back() != '/')
-                starttag += '/';
-            starttag += '>';
-
-            // parse the start tag updating the unit
-            xmlParserCtxtPtr context = xmlCreateMemoryParserCtxt(starttag.data(), (int) starttag.size());
-            auto save_private = context->_private;
-            context->_private = nunit;
-            auto save_sax = context->sax;
-            context->sax = &roottagsax;
-
-            // parse our single-element unit
-            xmlParseDocument(context);
-
-            // restore state and free
-            context->_private = save_private;
-            context->sax = save_sax;
-            xmlFreeParserCtxt(context);
-        }
-
-        // store in the returned results
-        result->units.push_back(nunit);
     }
 #ifdef _MSC_VER
 #   pragma warning(pop)
@@ -896,6 +972,349 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
     return SRCML_STATUS_OK;
 }
 
+/**
+ * transform_stream
+ * @param unit the unit to apply the transformation to
+ * @param stream the streaming form of the transformation
+ * @param result the transformation result to fill in
+ *
+ * Evaluate the transformation on the SAX events of the srcML of the unit,
+ * without building a DOM.
+ *
+ * @returns true if evaluated, and false if the DOM is needed
+ */
+static bool transform_stream(struct srcml_unit* unit, const xpath_stream& stream, struct srcml_transform_result* result) {
+
+    xpath_stream::result streamed;
+    if (!stream.evaluate(unit->srcml, streamed))
+        return false;
+
+    switch (stream.type()) {
+    case xpath_stream::COUNT:
+        result->type = SRCML_RESULT_NUMBER;
+        result->numberValue = (double) streamed.count;
+        return true;
+
+    case xpath_stream::BOOLEAN:
+        result->type = SRCML_RESULT_BOOLEAN;
+        result->boolValue = streamed.count > 0;
+        return true;
+
+    case xpath_stream::NODES:
+        break;
+    };
+
+    if (streamed.nodes.empty())
+        return true;
+
+    // find the position of the item attribute, if it exists
+    auto currentItemPosition = unit->attributes.size();
+    for (std::size_t i = 0; i < unit->attributes.size(); i += 2) {
+        if (unit->attributes[i].name == "item"sv) {
+            currentItemPosition = i;
+            break;
+        }
+    }
+
+    result_nodes(unit, currentItemPosition, false, result);
+    for (std::size_t i = 0; i < streamed.nodes.size(); ++i) {
+
+        result_node node;
+        node.srcml = std::move(streamed.nodes[i]);
+        node.usesCpp = streamed.uses_cpp[i];
+        node.usesOpenMP = streamed.uses_omp[i];
+
+        result->nodes.push_back(std::move(node));
+    }
+
+    return true;
+}
+
+/**
+ * transform_validate
+ * @param unit the unit to apply the transformation to
+ * @param validation the validation of the srcML of the unit
+ * @param result the transformation result to fill in
+ *
+ * Store the result of a validation without a DOM. A valid unit is its own result.
+ */
+static void transform_validate(struct srcml_unit* unit, const ValidationResult& validation, struct srcml_transform_result* result) {
+
+    if (!validation.valid)
+        return;
+
+    // find the position of the item attribute, if it exists
+    auto currentItemPosition = unit->attributes.size();
+    for (std::size_t i = 0; i < unit->attributes.size(); i += 2) {
+        if (unit->attributes[i].name == "item"sv) {
+            currentItemPosition = i;
+            break;
+        }
+    }
+
+    result->type = SRCML_RESULT_UNITS;
+    auto nunit = result_unit(unit, currentItemPosition, 0, 1, true);
+    nunit->srcml = unit->srcml;
+
+    if (validation.usesCpp)
+        result_unit_uses(nunit, SRCML_CPP_NS_DEFAULT_PREFIX, SRCML_CPP_NS_URI);
+    if (validation.usesOpenMP)
+        result_unit_uses(nunit, SRCML_OPENMP_NS_DEFAULT_PREFIX, SRCML_OPENMP_NS_URI);
+
+    nunit->content_begin = (int) nunit->srcml.find_first_of('>') + 1;
+    nunit->content_end = (int) nunit->srcml.find_last_of('<') + 1;
+    nunit->insert_begin = 0;
+    nunit->insert_end = 0;
+
+    result->units.push_back(nunit);
+}
+
+/**
+ * transform_pruned
+ * @param unit the unit to apply the transformation to
+ * @param trans the transformation
+ * @param result the transformation result to fill in
+ *
+ * Use a quick scan of the srcML of the unit, or the term index of the archive
+ * the unit is read from, to find units without a result, without building a DOM.
+ *
+ * @returns true if the unit has the empty result, and false if the transformation is needed
+ */
+static bool transform_pruned(struct srcml_unit* unit, const Transformation& trans, struct srcml_transform_result* result) {
+
+    const int language = srcml_check_language(srcml_unit_get_language(unit));
+
+    // the scan only rejects queries with a node set result
+    if (trans.rejects(unit->srcml, language))
+        return true;
+
+    if (!unit->archive || !unit->archive->term_index || unit->position == 0)
+        return false;
+
+    const auto query = trans.index_query(language);
+    if (!query || unit_term_index_contains(*unit->archive->term_index, unit->position - 1, *query))
+        return false;
+
+    switch (query->type) {
+    case unit_index_query::COUNT:
+        result->type = SRCML_RESULT_NUMBER;
+        result->numberValue = 0;
+        break;
+
+    case unit_index_query::BOOLEAN:
+        result->type = SRCML_RESULT_BOOLEAN;
+        result->boolValue = false;
+        break;
+
+    case unit_index_query::NODES:
+        break;
+    };
+
+    return true;
+}
+
+/**
+ * srcml_unit_apply_transforms
+ * @param iarchive an input srcml archive
+ * @param oarchive and output srcml archive
+ *
+ * Apply appended transformations inorder added and consecutively.
+ * Intermediate results are stored in a temporary file.
+ * Transformations are cleared.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit* unit, struct srcml_transform_result** presult) {
+    if (archive == nullptr || unit == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    // unit stays the same for no transformation
+    if (archive->transformations.empty())
+        return SRCML_STATUS_OK;
+
+    srcml_transform_result* result = nullptr;
+    if (presult) {
+        *presult = new srcml_transform_result;
+        result = *presult;
+        result->type = SRCML_RESULT_NONE;
+        result->boolValue = false;
+    }
+
+    // a single query is not evaluated on a unit the term index shows has no result
+    if (result && archive->transformations.size() == 1 && transform_pruned(unit, *archive->transformations.front(), result))
+        return SRCML_STATUS_OK;
+
+    // a single query in the streaming subset is evaluated without a DOM,
+    // unless there is already one from parsing
+    if (result && !unit->doc && archive->transformations.size() == 1) {
+        auto stream = archive->transformations.front()->stream();
+        if (stream && transform_stream(unit, *stream, result))
+            return SRCML_STATUS_OK;
+
+        // a single RelaxNG validation is on the srcML as it is read
+        const auto validation = archive->transformations.front()->validate(unit->srcml);
+        if (validation) {
+            transform_validate(unit, *validation, result);
+            return SRCML_STATUS_OK;
+        }
+    }
+
+    // create a DOM of the unit, using the one built during parsing if available
+    // since transformations change the document, it is used only once
+    std::shared_ptr<xmlDoc> doc(std::move(unit->doc));
+    if (doc == nullptr)
+        doc.reset(xmlReadMemory(unit->srcml.data(), (int) unit->srcml.size(), 0, 0, XML_PARSE_HUGE), [](xmlDoc* doc) { xmlFreeDoc(doc); });
+    if (doc == nullptr)
+        return SRCML_STATUS_ERROR;
+
+    // apply transformations sequentially on the results from the previous transformation
+    std::unique_ptr<xmlNodeSet> fullresults(xmlXPathNodeSetCreate(xmlDocGetRootElement(doc.get())));
+    if (fullresults == nullptr)
+        return SRCML_STATUS_ERROR;
+
+    // final result of all applied transformations
+    TransformationResult lastresult;
+    std::shared_ptr<xmlDoc> curdoc(doc);
+    for (const auto& trans : archive->transformations) {
+        // preserve the fullresults to iterate through
+        // collect results from this transformation applied to the potentially multiple
+        // results of the previous transformation step
+        std::unique_ptr<xmlNodeSet> pr(xmlXPathNodeSetCreate(0));
+        if (pr == nullptr)
+            return SRCML_STATUS_ERROR;
+        fullresults.swap(pr);
+
+        for (int i = 0; i < pr->nodeNr; ++i) {
+
+            xmlDocSetRootElement(curdoc.get(), pr->nodeTab[i]);
+
+            int language = srcml_check_language(srcml_unit_get_language(unit));
+            lastresult = trans->apply(curdoc.get(), language);
+            std::unique_ptr<xmlNodeSet> results(std::move(lastresult.nodeset));
+            if (results == nullptr) {
+                break;
+            }
+
+            xmlXPathNodeSetMerge(fullresults.get(), results.get());
+        }
+
+        // necessary to avoid access to free'd memory later on
+        // does NOT cause a memory leak
+        pr->nodeNr = 0;
+
+        // result of the transformation may be a new doc
+        if (lastresult.doc && lastresult.doc.get() != doc.get()) {
+            curdoc = lastresult.doc;
+        }
+
+        // if there are no results, then we can't apply further transformations
+        // but there still might be results in the scalar values
+        if (fullresults->nodeNr == 0) {
+            result->units.clear();
+            break;
+        }
+    }
+
+    return transform_result_units(unit, lastresult, fullresults.get(), curdoc.get(), result);
+}
+
+/**
+ * srcml_archive_get_transform_size
+ * @param archive a srcml archive
+ *
+ * @returns the number of appended transformations
+ */
+size_t srcml_archive_get_transform_size(const struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return 0;
+
+    return archive->transformations.size();
+}
+
+/**
+ * srcml_unit_apply_transforms_bundle
+ * @param archive a srcml archive with the transformations
+ * @param unit the unit to apply the transformations to
+ * @param results array with one result for each transformation
+ *
+ * Apply each appended transformation independently to the unit, instead
+ * of to the results of the previous one. The DOM of the unit is built
+ * once and shared by all the transformations. Only transformations that
+ * change the document, i.e., marking results with an element or attribute,
+ * are applied to a copy.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+int srcml_unit_apply_transforms_bundle(struct srcml_archive* archive, struct srcml_unit* unit, struct srcml_transform_result** results) {
+    if (archive == nullptr || unit == nullptr || results == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    for (std::size_t pos = 0; pos < archive->transformations.size(); ++pos) {
+        results[pos] = new srcml_transform_result;
+        results[pos]->type = SRCML_RESULT_NONE;
+        results[pos]->boolValue = false;
+    }
+
+    // unit stays the same for no transformation
+    if (archive->transformations.empty())
+        return SRCML_STATUS_OK;
+
+    // DOM of the unit, using the one built during parsing if available
+    // only built when a transformation needs it
+    std::shared_ptr<xmlDoc> doc(std::move(unit->doc));
+
+    int language = srcml_check_language(srcml_unit_get_language(unit));
+    for (std::size_t pos = 0; pos < archive->transformations.size(); ++pos) {
+        const auto& trans = archive->transformations[pos];
+
+        // queries are not evaluated on a unit the term index shows has no result
+        if (transform_pruned(unit, *trans, results[pos]))
+            continue;
+
+        // queries in the streaming subset are evaluated without the DOM
+        if (doc == nullptr && trans->stream() && transform_stream(unit, *trans->stream(), results[pos]))
+            continue;
+
+        // as are RelaxNG validations
+        if (doc == nullptr) {
+            const auto validation = trans->validate(unit->srcml);
+            if (validation) {
+                transform_validate(unit, *validation, results[pos]);
+                continue;
+            }
+        }
+
+        if (doc == nullptr)
+            doc.reset(xmlReadMemory(unit->srcml.data(), (int) unit->srcml.size(), 0, 0, XML_PARSE_HUGE), [](xmlDoc* doc) { xmlFreeDoc(doc); });
+        if (doc == nullptr)
+            return SRCML_STATUS_ERROR;
+
+        std::shared_ptr<xmlDoc> curdoc(doc);
+        if (trans->modifies_document())
+            curdoc.reset(xmlCopyDoc(doc.get(), 1), [](xmlDoc* doc) { xmlFreeDoc(doc); });
+        if (curdoc == nullptr)
+            return SRCML_STATUS_ERROR;
+
+        TransformationResult lastresult = trans->apply(curdoc.get(), language);
+        std::unique_ptr<xmlNodeSet> fullresults(std::move(lastresult.nodeset));
+        if (fullresults == nullptr)
+            fullresults.reset(xmlXPathNodeSetCreate(0));
+        if (fullresults == nullptr)
+            return SRCML_STATUS_ERROR;
+
+        // result of the transformation may be a new doc
+        if (lastresult.doc && lastresult.doc.get() != curdoc.get())
+            curdoc = lastresult.doc;
+
+        int status = transform_result_units(unit, lastresult, fullresults.get(), curdoc.get(), results[pos]);
+        if (status != SRCML_STATUS_OK)
+            return status;
+    }
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * Free the resources in a tranformation result.
  * @param results Struct of result
@@ -906,6 +1325,8 @@ int srcml_transform_free(struct srcml_transform_result* result) {
     for (auto unit : result->units) {
         srcml_unit_free(unit);
     }
+    if (result->nodes_unit)
+        srcml_unit_free(result->nodes_unit);
 
     delete result;
 
@@ -931,7 +1352,7 @@ int srcml_transform_get_unit_size(struct srcml_transform_result* result) {
     if (result->type != SRCML_RESULT_UNITS)
        return 0;
 
-    return (int) result->units.size();
+    return (int) (result->units.size() + result->nodes.size());
 }
 
 /**
@@ -945,12 +1366,95 @@ struct srcml_unit* srcml_transform_get_unit(struct srcml_transform_result* resul
     if (result->type != SRCML_RESULT_UNITS)
         return 0;
 
+    // result nodes are units once one is requested
+    if (!result->nodes.empty())
+        result_node_units(result);
+
     if (index >= (int) result->units.size())
         return 0;
 
     return result->units[static_cast<std::size_t>(index)];
 }
 
+/**
+ * srcml_archive_write_transform_result
+ * @param archive a srcml archive opened for writing
+ * @param result a srcml transformation result
+ *
+ * Write the units of the result to the archive. Result nodes of a query,
+ * and whole units of an XSLT result, are written in turn with a single
+ * unit, without a unit for each node.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error codes on failure.
+ */
+int srcml_archive_write_transform_result(struct srcml_archive* archive, struct srcml_transform_result* result) {
+
+    if (archive == nullptr || result == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (result->type != SRCML_RESULT_UNITS)
+        return SRCML_STATUS_OK;
+
+    for (auto unit : result->units) {
+        int status = srcml_archive_write_unit(archive, unit);
+        if (status != SRCML_STATUS_OK)
+            return status;
+    }
+
+    if (result->nodes.empty())
+        return SRCML_STATUS_OK;
+
+    // only the item attribute, or the attributes of a whole unit, the cpp and openmp namespaces,
+    // and the srcML change for each node
+    const int total = (int) result->nodes.size();
+    std::unique_ptr<srcml_unit> nunit(result_unit(result->nodes_unit, result->nodes_item, 0, total, result->nodes_wrapped));
+    const auto item = result->nodes_item < result->nodes_unit->attributes.size() ? result->nodes_item : nunit->attributes.size() - 1;
+    const auto namespaces = *nunit->namespaces;
+    nunit->insert_begin = 0;
+    nunit->insert_end = 0;
+
+    for (int i = 0; i < total; ++i) {
+        auto& node = result->nodes[(std::size_t) i];
+
+        // the start tag of a whole unit sets the attributes
+        if (result->nodes_wrapped) {
+            const auto base = result->nodes_unit;
+            nunit->revision = base->revision;
+            nunit->language = base->language;
+            nunit->filename = base->filename;
+            nunit->url = base->url;
+            nunit->version = base->version;
+            nunit->timestamp = base->timestamp;
+            nunit->hash = base->hash;
+            nunit->attributes = base->attributes;
+        } else {
+            nunit->attributes[item].value = result_item(result->nodes_unit, result->nodes_item, i, total);
+        }
+
+        *nunit->namespaces = namespaces;
+        if (node.usesCpp)
+            result_unit_uses(nunit.get(), SRCML_CPP_NS_DEFAULT_PREFIX, SRCML_CPP_NS_URI);
+        if (node.usesOpenMP)
+            result_unit_uses(nunit.get(), SRCML_OPENMP_NS_DEFAULT_PREFIX, SRCML_OPENMP_NS_URI);
+
+        // the node srcML is in the unit only while it is written
+        nunit->srcml.swap(node.srcml);
+        if (result->nodes_wrapped) {
+            result_unit_start_tag(nunit.get());
+        } else {
+            nunit->content_begin = 0;
+            nunit->content_end = (int) nunit->srcml.size() + 1;
+        }
+        int status = srcml_archive_write_unit(archive, nunit.get());
+        nunit->srcml.swap(node.srcml);
+
+        if (status != SRCML_STATUS_OK)
+            return status;
+    }
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * @param result A srcml transformation result
  * @return The transformation result string
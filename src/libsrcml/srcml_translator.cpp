@@ -139,6 +139,13 @@ void srcml_translator::translate(UTF8CharBuffer* parser_input) {
         textlexer.setSelector(&selector);
         textlexer.setTabsize((int)tabsize);
 
+        // lexers stamp tokens with their end position as characters are consumed
+        Position position;
+        if (isoption(options, SRCML_PARSER_OPTION_POSITION)) {
+            lexer.setPosition(&position);
+            textlexer.setPosition(&position);
+        }
+
         // switching between lexers
         selector.addInputStream(&lexer, "main");
         selector.addInputStream(&textlexer, "text");
@@ -273,9 +280,22 @@ bool srcml_translator::add_unit(const srcml_unit* unit) {
 
     if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
 
-        std::string s = extract_revision(unit->srcml.data() + unit->content_begin, size, (int) *unit->archive->revision_number);
-
-        xmlTextWriterWriteRawLen(out.getWriter(), BAD_CAST s.data(), (int) s.size());
+        // end the start tag, even when the revision is empty
+        xmlTextWriterWriteRawLen(out.getWriter(), BAD_CAST "", 0);
+
+        // write the parts of the revision directly, with the ranges of the unit if already found
+        const auto begin = static_cast<std::size_t>(unit->content_begin);
+        const auto end = begin + static_cast<std::size_t>(std::max(size, 0));
+        std::string_view srcml = unit->srcml;
+        std::optional<std::array<revision_ranges, 2>> found;
+        if (!unit->srcml_revision_ranges)
+            found = extract_revision_ranges(srcml.substr(0, end));
+        const auto& revisions = unit->srcml_revision_ranges ? *unit->srcml_revision_ranges : *found;
+        const auto& ranges = revisions[*unit->archive->revision_number == SRCDIFF_REVISION_ORIGINAL ? 0 : 1];
+
+        for_each_revision_range(srcml, ranges, begin, end, [&](std::string_view part) {
+            xmlTextWriterWriteRawLen(out.getWriter(), BAD_CAST part.data(), (int) part.size());
+        });
 
     } else if (size > 0) {
         xmlTextWriterWriteRawLen(out.getWriter(), BAD_CAST (unit->srcml.data() + unit->content_begin), size);
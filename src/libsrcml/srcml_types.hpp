@@ -27,13 +27,18 @@
 #include <Language.hpp>
 #include <language_extension_registry.hpp>
 
+#include <array>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 class srcml_sax2_reader;
+class srcml_parallel_reader;
 class srcml_translator;
+struct unit_index;
+struct unit_term_index;
 
 /**
  * SRCML_ARCHIVE_TYPE
@@ -91,11 +96,27 @@ struct srcml_archive {
     /** a srcMLReader for reading */
     srcml_sax2_reader* reader = nullptr;
 
+    /** a reader of the units on worker threads, when enabled */
+    srcml_parallel_reader* parallel_reader = nullptr;
+
     std::vector<std::shared_ptr<Transformation>> transformations;
 
     /** srcDiff revision number */
     std::optional<size_t> revision_number;
 
+    /** source of an archive open for reading, for random access to units */
+    std::optional<std::string> source_filename;
+    std::string_view source_memory;
+
+    /** index of the unit positions, loaded or built on the first random access */
+    std::shared_ptr<unit_index> index;
+
+    /** index of the units that contain each term, to skip units that cannot match a query */
+    std::shared_ptr<unit_term_index> term_index;
+
+    /** number of units read, for the position of each unit */
+    size_t units_read = 0;
+
     /** output buffer for io, filename, FILE*, and fd */
     xmlOutputBuffer* output_buffer = nullptr;
     xmlBuffer* xbuffer = nullptr;
@@ -112,6 +133,9 @@ struct srcml_archive {
     int error_number = 0;
 };
 
+/** [begin, end) offsets of the srcML of a unit that are in a srcdiff revision */
+typedef std::vector<std::pair<std::size_t, std::size_t>> revision_ranges;
+
 /**
  * srcml_unit
  *
@@ -166,6 +190,8 @@ struct srcml_unit {
     std::string srcml;
     std::optional<std::string> srcml_revision;
     int currevision = -1;
+    /** ranges of the srcml in the original and modified srcdiff revisions */
+    std::optional<std::array<revision_ranges, 2>> srcml_revision_ranges;
     std::optional<std::string> srcml_fragment;
     std::optional<std::string> srcml_fragment_revision;
     std::optional<std::string> srcml_raw;
@@ -174,6 +200,12 @@ struct srcml_unit {
     /** src from read */
     std::optional<std::string> src;
 
+    /** position of the unit in the archive it is read from, starting at 1, or 0 if not read */
+    size_t position = 0;
+
+    /** document of the srcml built while parsing, used once by transformations */
+    std::shared_ptr<xmlDoc> doc;
+
     /** record the begin and end of the actual content */
     // int instead of size_t since used with libxml2
     int content_begin = 0;
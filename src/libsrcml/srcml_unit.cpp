@@ -455,6 +455,32 @@ size_t srcml_unit_get_eol(struct srcml_unit* unit) {
     return unit->eol;
 }
 
+/**
+ * srcml_unit_revision_ranges
+ * @param unit a srcml unit of a srcdiff archive with a revision
+ *
+ * The ranges of both revisions are found in a single scan of the srcML
+ * of the unit, and shared by all the srcML of the unit. The extracted
+ * srcML is for the current revision of the archive.
+ *
+ * @returns the ranges of the srcML of the unit in the revision
+ */
+static const revision_ranges& srcml_unit_revision_ranges(struct srcml_unit* unit) {
+
+    if (!unit->srcml_revision_ranges)
+        unit->srcml_revision_ranges = extract_revision_ranges(unit->srcml);
+
+    const int revision = (int) *unit->archive->revision_number;
+    if (unit->currevision != revision) {
+        unit->currevision = revision;
+        unit->srcml_revision.reset();
+        unit->srcml_fragment_revision.reset();
+        unit->srcml_raw_revision.reset();
+    }
+
+    return (*unit->srcml_revision_ranges)[revision == SRCDIFF_REVISION_ORIGINAL ? 0 : 1];
+}
+
 /**
  * srcml_unit_get_srcml
  * @param unit a srcml unit
@@ -477,14 +503,61 @@ const char* srcml_unit_get_srcml(struct srcml_unit* unit) {
         unit->archive->reader->read_body(unit);
 
     if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
-        if (!unit->srcml_revision || unit->currevision != (int) *unit->archive->revision_number)
-            unit->srcml_revision = extract_revision(unit->srcml.data(), (int) unit->srcml.size(), (int) *unit->archive->revision_number);
+        const auto& ranges = srcml_unit_revision_ranges(unit);
+        if (!unit->srcml_revision)
+            unit->srcml_revision = extract_revision(unit->srcml, ranges, 0, unit->srcml.size());
         return unit->srcml_revision->data();
     }
 
     return unit->srcml.data();
 }
 
+/**
+ * srcml_unit_outer_ranges
+ * @param unit a srcml unit with its srcML read
+ * @param ranges the ranges of the srcML of the unit that form the fragment
+ *
+ * The fragment is the full srcML, excluding the inserted root tag stuff
+ * (including namespaces) and the url attribute.
+ *
+ * @returns the number of ranges
+ */
+static int srcml_unit_outer_ranges(const struct srcml_unit* unit, std::string_view ranges[3]) {
+
+    std::string_view srcml = unit->srcml;
+
+    // find end of unit tag, e.g., end of "<unit ...>" or "<src:unit ...>"
+    auto pos = srcml.find(">");
+
+    size_t insert_attr_begin = 0;
+    size_t insert_attr_end = 0;
+
+    if (pos != std::string_view::npos) {
+        // find url attribute
+        auto pos2 = srcml.substr(0, pos).find(" url=");
+        if (pos2 != std::string_view::npos) {
+            insert_attr_begin = pos2;
+            pos2 += 6;
+            auto pos3 = srcml.substr(0, pos).find("\"", pos2);
+            pos3 += 1;
+            insert_attr_end = pos3;
+        }
+    }
+
+    const auto insert_begin = static_cast<std::size_t>(unit->insert_begin);
+    const auto insert_end = static_cast<std::size_t>(unit->insert_end);
+
+    ranges[0] = srcml.substr(0, insert_begin);
+    if (insert_attr_begin == 0) {
+        ranges[1] = srcml.substr(insert_end);
+        return 2;
+    }
+
+    ranges[1] = srcml.substr(insert_end, insert_attr_begin - insert_end);
+    ranges[2] = srcml.substr(insert_attr_end);
+    return 3;
+}
+
 /**
  * srcml_unit_get_srcml_outer
  * @param unit a srcml unit
@@ -505,51 +578,82 @@ const char* srcml_unit_get_srcml_outer(struct srcml_unit* unit) {
     if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
         unit->archive->reader->read_body(unit);
 
-    // size of resulting raw version (no unit tag)
-    auto rawsize = unit->srcml.size() - (unit->insert_end - unit->insert_begin);
+    // if srcdiff versioned, then use the ranges of the fragment in the revision
+    if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
+        const auto& ranges = srcml_unit_revision_ranges(unit);
+        if (!unit->srcml_fragment_revision) {
+
+            std::string_view outer[3];
+            int count = srcml_unit_outer_ranges(unit, outer);
+
+            unit->srcml_fragment_revision = "";
+            for (int i = 0; i < count; ++i) {
+                const auto begin = (std::size_t) (outer[i].data() - unit->srcml.data());
+                for_each_revision_range(unit->srcml, ranges, begin, begin + outer[i].size(), [&](std::string_view part) {
+                    unit->srcml_fragment_revision->append(part);
+                });
+            }
+        }
+        return unit->srcml_fragment_revision->data();
+    }
 
-    // construct the fragment from the full srcML, excluding the inserted root tag stuff (including namespaces)
+    // construct the fragment from the ranges of the full srcML
     if (!unit->srcml_fragment) {
 
-        // find end of unit tag, e.g., end of "<unit ...>" or "<src:unit ...>"
-        // std::string_view prefix = "";
-        auto pos = unit->srcml.find(">");
-
-        int insert_attr_begin = 0;
-        int insert_attr_end = 0;
-
-        if (pos != std::string::npos) {
-            // find url attribute
-            std::string s(unit->srcml, 0, pos);
-            auto pos2 = s.find(" url=");
-            if (pos2 != std::string::npos) {
-                insert_attr_begin = (int) pos2;
-                pos2 += 6;
-                auto pos3 = s.find("\"", pos2);
-                pos3 += 1;
-                insert_attr_end = (int) pos3;
-            }
-        }
+        std::string_view ranges[3];
+        int count = srcml_unit_outer_ranges(unit, ranges);
 
         unit->srcml_fragment = "";
-        unit->srcml_fragment->reserve(rawsize);
-        unit->srcml_fragment->assign(unit->srcml, 0, static_cast<std::size_t>(unit->insert_begin));
-        if (insert_attr_begin == 0) {
-            unit->srcml_fragment->append(unit->srcml, static_cast<std::size_t>(unit->insert_end), static_cast<std::size_t>(unit->srcml.size() - unit->insert_end));
-        } else {
-            unit->srcml_fragment->append(unit->srcml, static_cast<std::size_t>(unit->insert_end), static_cast<std::size_t>(insert_attr_begin - unit->insert_end));
-            unit->srcml_fragment->append(unit->srcml, static_cast<std::size_t>(insert_attr_end), static_cast<std::size_t>(unit->srcml.size() - insert_attr_end));
-        }
+        unit->srcml_fragment->reserve(unit->srcml.size() - (unit->insert_end - unit->insert_begin));
+        for (int i = 0; i < count; ++i)
+            unit->srcml_fragment->append(ranges[i]);
     }
 
-    // if srcdiff versioned, then use that
+    return unit->srcml_fragment->data();
+}
+
+/**
+ * srcml_unit_get_srcml_outer_view
+ * @param unit a srcml unit
+ * @param data array of at least 3 pointers to the start of the ranges
+ * @param sizes array of at least 3 sizes of the ranges
+ * @param count the number of ranges
+ *
+ * Get the srcml fragment of srcml_unit_get_srcml_outer() as ranges
+ * of the stored srcml of the unit, without a copy. The ranges are not
+ * null terminated. For a srcdiff revision, there is a single range
+ * of the extracted revision.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_unit_get_srcml_outer_view(struct srcml_unit* unit, const char* data[3], size_t sizes[3], int* count) {
+
+    if (unit == nullptr || data == nullptr || sizes == nullptr || count == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (!unit->read_body && !unit->read_header)
+        return SRCML_STATUS_UNINITIALIZED_UNIT;
+
+    if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
+        unit->archive->reader->read_body(unit);
+
+    // srcdiff revision is extracted from the fragment
     if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
-        if (!unit->srcml_fragment_revision || unit->currevision != (int) *unit->archive->revision_number)
-            unit->srcml_fragment_revision = extract_revision(unit->srcml_fragment->data(), (int) unit->srcml_fragment->size(), (int) *unit->archive->revision_number);
-        return unit->srcml_fragment_revision->data();
+        std::string_view s = srcml_unit_get_srcml_outer(unit);
+        data[0] = s.data();
+        sizes[0] = s.size();
+        *count = 1;
+        return SRCML_STATUS_OK;
     }
 
-    return unit->srcml_fragment->data();
+    std::string_view ranges[3];
+    *count = srcml_unit_outer_ranges(unit, ranges);
+    for (int i = 0; i < *count; ++i) {
+        data[i] = ranges[i].data();
+        sizes[i] = ranges[i].size();
+    }
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -581,8 +685,9 @@ const char* srcml_unit_get_srcml_inner(struct srcml_unit* unit) {
 
     // if srcdiff versioned, then use that
     if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
-        if (!unit->srcml_raw_revision || unit->currevision != (int) *unit->archive->revision_number)
-            unit->srcml_raw_revision = extract_revision(unit->srcml.data() + start, rawsize, (int) *unit->archive->revision_number);
+        const auto& ranges = srcml_unit_revision_ranges(unit);
+        if (!unit->srcml_raw_revision)
+            unit->srcml_raw_revision = extract_revision(unit->srcml, ranges, (std::size_t) start, (std::size_t) (start + rawsize));
         return unit->srcml_raw_revision->data();
     }
 
@@ -595,6 +700,49 @@ const char* srcml_unit_get_srcml_inner(struct srcml_unit* unit) {
     return unit->srcml_raw->data();
 }
 
+/**
+ * srcml_unit_get_srcml_inner_view
+ * @param unit a srcml unit
+ * @param data the start of the srcml
+ * @param size the size of the srcml
+ *
+ * Get the srcml of srcml_unit_get_srcml_inner() as a view of the stored
+ * srcml of the unit, without a copy. The view is not null terminated.
+ *
+ * @returns Returns SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_unit_get_srcml_inner_view(struct srcml_unit* unit, const char** data, size_t* size) {
+
+    if (unit == nullptr || data == nullptr || size == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (!unit->read_body && !unit->read_header)
+        return SRCML_STATUS_UNINITIALIZED_UNIT;
+
+    if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
+        unit->archive->reader->read_body(unit);
+
+    int rawsize = unit->content_end - unit->content_begin - 1;
+    if (rawsize <= 0) {
+        *data = "";
+        *size = 0;
+        return SRCML_STATUS_OK;
+    }
+
+    // srcdiff revision is extracted from the srcml
+    if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
+        std::string_view s = srcml_unit_get_srcml_inner(unit);
+        *data = s.data();
+        *size = s.size();
+        return SRCML_STATUS_OK;
+    }
+
+    *data = unit->srcml.data() + unit->content_begin;
+    *size = static_cast<std::size_t>(rawsize);
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * srcml_unit_get_namespace_size
  * @param unit a srcml_unit
@@ -706,6 +854,47 @@ const char* srcml_unit_get_uri_from_prefix(const struct srcml_unit* unit, const
  *                                                                            *
  ******************************************************************************/
 
+/**
+ * create_unit_document
+ * @param unit a srcml unit with the final srcml
+ * @param content document of the unit contents from the parser
+ *
+ * Replace the placeholder root of the contents with the final unit element,
+ * which has all the used namespaces.
+ *
+ * @returns the document of the unit, or null on error.
+ */
+static std::shared_ptr<xmlDoc> create_unit_document(srcml_unit* unit, std::unique_ptr<xmlDoc> content) {
+
+    // empty units are short enough that reparsing is not an issue
+    if (unit->content_begin == unit->content_end)
+        return nullptr;
+
+    // unit element from the start tag
+    std::string unit_tag(unit->srcml, 0, unit->content_begin - 1);
+    unit_tag += "/>";
+    std::unique_ptr<xmlDoc> tag_doc(xmlReadMemory(unit_tag.data(), (int) unit_tag.size(), 0, 0, 0));
+    if (!tag_doc)
+        return nullptr;
+
+    xmlNode* unit_element = xmlDocCopyNode(xmlDocGetRootElement(tag_doc.get()), content.get(), 2);
+    if (!unit_element)
+        return nullptr;
+
+    // move the contents to the unit element
+    xmlNode* placeholder = xmlDocSetRootElement(content.get(), unit_element);
+    xmlNode* children = placeholder->children;
+    placeholder->children = placeholder->last = nullptr;
+    if (children)
+        xmlAddChildList(unit_element, children);
+
+    // contents refer to the namespaces declared on the placeholder
+    xmlReconciliateNs(content.get(), unit_element);
+    xmlFreeNode(placeholder);
+
+    return std::shared_ptr<xmlDoc>(content.release(), [](xmlDoc* doc) { xmlFreeDoc(doc); });
+}
+
 /**
  * srcml_unit_parse_internal
  * @param unit a srcml unit
@@ -770,6 +959,11 @@ static int srcml_unit_parse_internal(struct srcml_unit* unit, const char* filena
     if (status != SRCML_STATUS_OK)
         return status;
 
+    // transformations use a document built during parsing instead of reparsing the srcml
+    bool build_document = !unit->archive->transformations.empty();
+    if (build_document)
+        unit->unit_translator->out.startDocument();
+
     // parse the input
     unit->unit_translator->translate(input);
 
@@ -777,8 +971,16 @@ static int srcml_unit_parse_internal(struct srcml_unit* unit, const char* filena
     // namespaces that were optional
     unit->namespaces = unit->unit_translator->out.getNamespaces();
 
+    std::unique_ptr<xmlDoc> content(build_document ? unit->unit_translator->out.releaseDocument() : nullptr);
+
     // create the unit end tag
-    return srcml_write_end_unit(unit);
+    status = srcml_write_end_unit(unit);
+    if (status != SRCML_STATUS_OK || !content)
+        return status;
+
+    unit->doc = create_unit_document(unit, std::move(content));
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -1138,6 +1340,56 @@ int srcml_unit_unparse_io(struct srcml_unit* unit, void* context, int (*write_ca
     });
 }
 
+namespace {
+
+    // output buffers kept per thread so that the memory they have grown to is reused by later units
+    thread_local std::vector<std::unique_ptr<xmlBuffer>> unit_buffer_pool;
+
+    // number of buffers kept per thread
+    constexpr std::size_t UNIT_BUFFER_POOL_SIZE = 4;
+
+    // buffers that grew larger than this are freed instead of kept
+    constexpr int UNIT_BUFFER_POOL_MAX_LENGTH = 16 * 1024 * 1024;
+
+    /**
+     * acquire_unit_buffer
+     *
+     * Get an empty output buffer for a unit, reusing one from this thread if available.
+     *
+     * @returns an empty buffer or nullptr on failure
+     */
+    xmlBuffer* acquire_unit_buffer() {
+
+        if (unit_buffer_pool.empty())
+            return xmlBufferCreate();
+
+        xmlBuffer* buffer = unit_buffer_pool.back().release();
+        unit_buffer_pool.pop_back();
+
+        return buffer;
+    }
+
+    /**
+     * release_unit_buffer
+     * @param buffer an output buffer from acquire_unit_buffer()
+     *
+     * Empty the buffer and keep it for later units on this thread.
+     */
+    void release_unit_buffer(xmlBuffer* buffer) {
+
+        if (buffer == nullptr)
+            return;
+
+        if (unit_buffer_pool.size() >= UNIT_BUFFER_POOL_SIZE || xmlBufferLength(buffer) > UNIT_BUFFER_POOL_MAX_LENGTH) {
+            xmlBufferFree(buffer);
+            return;
+        }
+
+        xmlBufferEmpty(buffer);
+        unit_buffer_pool.emplace_back(buffer);
+    }
+}
+
 /**
  * srcml_write_start_unit
  * @param archive a srcml archive opened for writing
@@ -1156,7 +1408,7 @@ int srcml_write_start_unit(struct srcml_unit* unit) {
         return SRCML_STATUS_INVALID_ARGUMENT;
 
     // setup the output buffer where the srcML will be created
-    std::unique_ptr<xmlBuffer> output_buffer(xmlBufferCreate());
+    std::unique_ptr<xmlBuffer, decltype(&release_unit_buffer)> output_buffer(acquire_unit_buffer(), release_unit_buffer);
     if (!output_buffer)
         return SRCML_STATUS_IO_ERROR;
 
@@ -1177,7 +1429,7 @@ int srcml_write_start_unit(struct srcml_unit* unit) {
             unit->unit_translator->close();
             delete unit->unit_translator;
             unit->unit_translator = nullptr;
-            xmlBufferFree(unit->output_buffer);
+            release_unit_buffer(unit->output_buffer);
             unit->output_buffer = nullptr;
         }
         unit->unit_translator = new srcml_translator(
@@ -1255,11 +1507,19 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
     if (!unit->unit_translator->add_end_unit())
         return SRCML_STATUS_INVALID_INPUT;
 
-    // flush before detaching
+    // flush before taking the content
     xmlTextWriterFlush(unit->unit_translator->output_textwriter());
 
-    // store the generated srcml in a char buffer
-    char* srcml = (char*) xmlBufferDetach(unit->output_buffer);
+    // keep the buffer with the generated srcml, since the start unit reuses the unit output buffer
+    xmlBuffer* content_buffer = unit->output_buffer;
+    unit->output_buffer = nullptr;
+    const auto size = (std::size_t) xmlBufferLength(content_buffer);
+
+    // close the translator before taking the content, since closing writes to the buffer
+    unit->unit_translator->close();
+    delete unit->unit_translator;
+    unit->unit_translator = nullptr;
+    std::string_view srcml((const char*) xmlBufferContent(content_buffer), size);
 
     // record the current content_begin (which may change)
     int content_begin = unit->content_begin;
@@ -1267,15 +1527,16 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
 
     // redo the start element with the namespaces found in the document
     srcml_write_start_unit(unit);
-    char* start_tag = (char*) xmlBufferDetach(unit->output_buffer);
+    const char* start_tag = (const char*) xmlBufferContent(unit->output_buffer);
 
     // recreate the unit with the newly generated start tag, which
     // contains all the used namespaces
     unit->srcml.assign(start_tag);
+    unit_reset_srcml_parts(unit);
 
     if (content_begin != content_end) {
         unit->srcml += '>';
-        unit->srcml.append(srcml + content_begin);
+        unit->srcml.append(srcml.substr((std::size_t) content_begin));
     } else {
         unit->srcml += '/';
         unit->srcml += '>';
@@ -1284,9 +1545,6 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
     // content end is changed since the start unit tag was rewritten
     unit->content_end += (unit->content_begin - content_begin);
 
-    free(start_tag);
-    free(srcml);
-
     // record the loc
     if (!unit->src) {
         unit->src = extract_src(unit->srcml);
@@ -1300,10 +1558,16 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
     delete unit->unit_translator;
     unit->unit_translator = 0;
 
-    xmlBufferFree(unit->output_buffer);
+    // buffers are released only after the translator, which flushes on close
+    release_unit_buffer(content_buffer);
+    release_unit_buffer(unit->output_buffer);
+    unit->output_buffer = nullptr;
 
     unit->read_body = true;
 
+    // any previous document is out of date
+    unit->doc.reset();
+
     return SRCML_STATUS_OK;
 }
 
@@ -8,9 +8,19 @@
 #ifndef SRCQL_HPP
 #define SRCQL_HPP
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 #define SRCQL_VERSION_NUMBER 10000
 #define SRCQL_VERSION_STRING "1.0.0"
 
+// Element names and element text that every match of a query contains
+struct srcql_features {
+    std::vector<std::string> elements;
+    std::vector<std::string> text;
+};
+
 // The current version of srcQL as a number
 int srcql_version_number();
 
@@ -20,5 +30,14 @@ const char* srcql_version_string();
 // srcQuery -> XPath
 const char* srcql_convert_query_to_xpath(const char* src_query, const char* language);
 
+// Persistent cache of conversions, loaded now and added to by new conversions
+// false if the file exists and is not a cache
+bool srcql_set_cache(const char* filename);
+
+// srcQuery -> features every match contains, empty when none are known
+srcql_features srcql_query_features(const char* src_query, const char* language);
+
+// Quick scan of the srcML of a unit, false when a feature is missing
+bool srcql_features_found(const srcql_features& features, std::string_view srcml);
 
 #endif
@@ -37,9 +37,12 @@ public:
 
     /* Internal context handling NOT FOR PUBLIC USE */
 
-    /** xml parser input buffer */
+    /** xml parser input buffer, pushed to the parser in chunks */
     std::unique_ptr<xmlParserInputBuffer> input;
 
+    /** position in the input buffer of the next chunk */
+    size_t input_offset = 0;
+
     /** internally used libxml2 context */
     xmlParserCtxtPtr libxml2_context = nullptr;
 };
@@ -53,6 +56,9 @@ void srcsax_free_context(srcsax_context * context);
 /* srcSAX parse function */
 int srcsax_parse(srcsax_context * context);
 
+/* srcSAX incremental parse function */
+int srcsax_parse_chunk(srcsax_context* context);
+
 /* srcSAX terminate parse function */
 void srcsax_stop_parser(srcsax_context* context);
 
@@ -11,6 +11,7 @@
 #include <libxml/parserInternals.h>
 
 #include <functional>
+#include <algorithm>
 
 /**
  * libxml_error
@@ -25,17 +26,18 @@ static void libxml_error(void * /*ctx*/, const char* msg, ...) {
     va_end(vl);
 }
 
+/** size of the chunks of input pushed to the parser */
+static const int SRCSAX_CHUNK_SIZE = 4096;
+
 /* srcsax_create_parser_context forward declaration */
-static xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input, xmlCharEncoding enc);
+static xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input);
 
 /**
  * srcsax_create_context_parser_input_buffer
- * @param srcml_context an opened context for opened srcML document
- * @param read_callback a read callback function
- * @close_callback a close callback function
- * @param encoding the files character encoding
+ * @param input a parser input buffer
  *
- * Create a srcsSAX context from a general context and read/close callbacks with the specified encoding.
+ * Create a srcSAX context from a parser input buffer. The input buffer
+ * is kept by the context, and pushed to the parser in chunks.
  *
  * @returns srcsax_context context to be used for srcML parsing.
  */
@@ -44,8 +46,6 @@ srcsax_context* srcsax_create_context_parser_input_buffer(std::unique_ptr<xmlPar
     if (!input)
         return 0;
 
-    const char* encoding = nullptr;
-
     srcsax_context* context = nullptr;
     try {
         context = new srcsax_context();
@@ -55,7 +55,7 @@ srcsax_context* srcsax_create_context_parser_input_buffer(std::unique_ptr<xmlPar
 
     context->input = std::move(input);
 
-    xmlParserCtxtPtr libxml2_context = srcsax_create_parser_context(context->input.release(), encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
+    xmlParserCtxtPtr libxml2_context = srcsax_create_parser_context(context->input.get());
     if (libxml2_context == nullptr) {
         delete context;
         return 0;
@@ -81,8 +81,13 @@ void srcsax_free_context(srcsax_context* context) {
     if (context == 0)
         return;
 
-    if (context->libxml2_context)
+    if (context->libxml2_context) {
+
+        delete (sax2_srcsax_handler*) context->libxml2_context->_private;
+        context->libxml2_context->_private = nullptr;
+
         xmlFreeParserCtxt(context->libxml2_context);
+    }
 
     delete context;
 }
@@ -98,62 +103,104 @@ void srcsax_free_context(srcsax_context* context) {
  */
 int srcsax_parse(srcsax_context* context) {
 
+    int status = 0;
+    while ((status = srcsax_parse_chunk(context)) == 1)
+        ;
+
+    return status;
+}
+
+/**
+ * srcsax_parse_chunk
+ * @param context srcSAX context
+ *
+ * Push the next chunk of input to the parser using the provided sax handlers.
+ * The parse state is kept in the context between calls, so the document is
+ * parsed incrementally on the calling thread.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 1 if there is more to parse, 0 when the document is parsed, and -1 on error.
+ */
+int srcsax_parse_chunk(srcsax_context* context) {
+
     if (context == 0 || context->handler == 0)
         return -1;
 
-    xmlSAXHandlerPtr save_sax = context->libxml2_context->sax;
+    xmlParserCtxtPtr ctxt = context->libxml2_context;
+    if (ctxt->instate == XML_PARSER_EOF)
+        return 0;
+
+    // first chunk, so setup the sax handlers and the state kept between chunks
+    if (ctxt->_private == nullptr) {
+
+        *ctxt->sax = srcsax_sax2_factory();
 
-    xmlSAXHandler sax = srcsax_sax2_factory();
-    context->libxml2_context->sax = &sax;
+        auto state = new sax2_srcsax_handler();
+        state->context = context;
+        ctxt->_private = state;
+    }
+
+    // next chunk of the input, already converted to UTF-8 by the input buffer
+    // only shrink an empty input buffer, as shrinking may move the rest of the input
+    xmlParserInputBufferPtr input = context->input.get();
+    if (context->input_offset == xmlBufUse(input->buffer)) {
 
-    sax2_srcsax_handler state;
-    state.context = context;
-    context->libxml2_context->_private = &state;
+        xmlBufShrink(input->buffer, context->input_offset);
+        context->input_offset = 0;
+
+        xmlParserInputBufferGrow(input, SRCSAX_CHUNK_SIZE);
+    }
 
-    int status = xmlParseDocument(context->libxml2_context);
+    int size = (int) std::min(xmlBufUse(input->buffer) - context->input_offset, (size_t) SRCSAX_CHUNK_SIZE);
 
-    context->libxml2_context->sax = save_sax;
+    // no more input terminates the parse
+    int status = xmlParseChunk(ctxt, (const char*) xmlBufContent(input->buffer) + context->input_offset, size, size == 0);
 
-    if (status != 0 && context->srcsax_error) {
+    context->input_offset += (size_t) size;
 
-        auto ep = xmlCtxtGetLastError(context->libxml2_context);
+    if (status != 0) {
 
-        auto str_length = std::string_view(ep->message).size();
-        ep->message[str_length - 1] = '\0';
+        if (context->srcsax_error) {
 
-        context->srcsax_error((const char *)ep->message, ep->code);
+            auto ep = xmlCtxtGetLastError(context->libxml2_context);
+
+            auto str_length = std::string_view(ep->message).size();
+            ep->message[str_length - 1] = '\0';
+
+            context->srcsax_error((const char *)ep->message, ep->code);
+        }
+
+        return -1;
     }
 
-    return status;
+    return ctxt->instate == XML_PARSER_EOF ? 0 : 1;
 }
 
 /**
  * srcsax_create_parser_context
  * @param buffer_input a parser input buffer
  *
- * Create a ctxt from a parser input buffer.
- * Modeled after function in libxml2.
+ * Create a push parser ctxt for the contents of a parser input buffer.
  *
  * @returns xml parser ctxt
  */
-xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input, xmlCharEncoding enc) {
+xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input) {
 
     if (buffer_input == 0)
         return 0;
 
-    xmlParserCtxtPtr ctxt = xmlNewParserCtxt();
+    xmlParserCtxtPtr ctxt = xmlCreatePushParserCtxt(0, 0, 0, 0, 0);
     if (ctxt == 0)
         return 0;
 
-    xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
-
-    xmlParserInputPtr input = xmlNewIOInputStream(ctxt, buffer_input, enc);
-    if (input == 0) {
-        xmlFreeParserCtxt(ctxt);
-        return 0;
+    // input buffer with an encoder pushes UTF-8, so the declared encoding no longer applies
+    int options = XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT;
+    if (buffer_input->encoder) {
+        options |= XML_PARSE_IGNORE_ENC;
+        ctxt->encoding = xmlStrdup((const xmlChar*) buffer_input->encoder->name);
     }
 
-    inputPush(ctxt, input);
+    xmlCtxtUseOptions(ctxt, options);
 
     return ctxt;
 }
@@ -7,58 +7,135 @@
 
 #include "unification_table.hpp"
 
+#include <algorithm>
+#include <memory>
+
+// Compile the pattern, recognizing the literal forms
+regex_rule::regex_rule(std::string_view pattern) {
+
+    std::string_view rest = pattern;
+    if (!rest.empty() && rest.front() == '^')
+        rest.remove_prefix(1);
+    if (!rest.empty() && rest.back() == '$')
+        rest.remove_suffix(1);
+
+    const bool anyStart = rest.substr(0, 2) == ".*";
+    if (anyStart)
+        rest.remove_prefix(2);
+
+    const bool anyEnd = rest.size() >= 2 && rest.substr(rest.size() - 2) == ".*";
+    if (anyEnd)
+        rest.remove_suffix(2);
+
+    // an escaped $ leaves a trailing backslash, so falls through to a regex
+    if (rest.find_first_of("\\^$.|?*+()[]{}") == std::string_view::npos) {
+        literal = rest;
+        kind = anyStart && anyEnd ? CONTAINS : anyStart ? SUFFIX : anyEnd ? PREFIX : LITERAL;
+        return;
+    }
+
+    try {
+        regex = std::regex(pattern.begin(), pattern.end());
+    } catch (const std::regex_error&) {
+        kind = INVALID;
+    }
+}
+
+// If the part of a token matched by .* has no line terminator, which an ECMAScript . does not match
+static bool any_match(std::string_view part) {
+
+    return part.find_first_of("\n\r") == std::string_view::npos;
+}
+
+// If the entire token matches the rule
+bool regex_rule::match(std::string_view token) const {
+
+    switch (kind) {
+    case LITERAL:
+        return token == literal;
+    case PREFIX:
+        return token.substr(0, literal.size()) == literal && any_match(token.substr(literal.size()));
+    case SUFFIX:
+        return token.size() >= literal.size() && token.substr(token.size() - literal.size()) == literal
+            && any_match(token.substr(0, token.size() - literal.size()));
+    case CONTAINS: {
+
+        // the literal must cover all of the line terminators of the token
+        const auto first = token.find_first_of("\n\r");
+        if (first == std::string_view::npos)
+            return token.find(literal) != std::string_view::npos;
+        const auto last = token.find_last_of("\n\r");
+
+        const auto start = last + 1 > literal.size() ? last + 1 - literal.size() : 0;
+        const auto pos = token.find(literal, start);
+        return pos != std::string_view::npos && pos <= first;
+    }
+    case REGEX:
+        return std::regex_match(token.begin(), token.end(), regex);
+    default:
+        return false;
+    }
+}
+
 // Adds a number bucket to the variable bucket if doesn't exist
-void UnificationTable::add_to_variable_bucket(std::string_view variable_identifier) {
+void UnificationTable::add_to_variable_bucket(size_t variable_identifier) {
 
     // if doesn't exist, add
-    bucket.try_emplace(std::string(variable_identifier));
+    if (buckets.size() <= variable_identifier)
+        buckets.resize(variable_identifier + 1);
 }
 
 // Gets number of number buckets added to a variable bucket
-size_t UnificationTable::size_of_variable_bucket(std::string_view variable_identifier) const {
+size_t UnificationTable::size_of_variable_bucket(size_t variable_identifier) const {
 
-    const auto numberBucket = bucket.find(variable_identifier);
-    if (numberBucket == bucket.end())
+    if (variable_identifier >= buckets.size())
         return 0;
 
-    return numberBucket->second.size();
+    return buckets[variable_identifier].size();
 }
 
 // Returns if any variable bucket has 2 or more number buckets
 bool UnificationTable::will_unification_occur() const {
 
-    for (const auto& variable : bucket) {
-        if (variable.second.size() > 1)
+    for (const auto& variable : buckets) {
+        if (variable.size() > 1)
             return true;
     }
     return false;
 }
 
 // Adds a token list to a number bucket
-void UnificationTable::add_to_number_bucket(std::string_view variable_identifier, size_t order) {
+void UnificationTable::add_to_number_bucket(size_t variable_identifier, size_t order) {
 
-    const auto numberBucket = bucket.find(variable_identifier);
-    if (numberBucket == bucket.end())
+    if (variable_identifier >= buckets.size())
         return;
 
     // Does NOT perform checks to see if token list already exists
     // at the order location
-    numberBucket->second.emplace(order, token_list());
+    auto& numberBucket = buckets[variable_identifier];
+    if (numberBucket.size() < order)
+        numberBucket.resize(order);
 }
 
 // Adds a token-address pair to a token list
-void UnificationTable::add_to_token_list(std::string_view variable_identifier, size_t order, std::string_view token, std::uintptr_t address) {
+void UnificationTable::add_to_token_list(size_t variable_identifier, size_t order, std::string_view token, std::uintptr_t address) {
+
+    // orders start at 1
+    if (order == 0)
+        return;
+
+    add_to_variable_bucket(variable_identifier);
+    add_to_number_bucket(variable_identifier, order);
 
     // Do NOT insert if element is already in
-    auto& bucketOrder = bucket.find(variable_identifier)->second[order];
+    auto& bucketOrder = buckets[variable_identifier][order - 1];
     for (const auto& element : bucketOrder) {
         if (element.address == address)
             return;
     }
 
     // add the unique element
-    unique_element added{ token, address };
-    bucketOrder.push_back(std::move(added));
+    bucketOrder.push_back(unique_element{ token, address });
 }
 
 // Loops through the previous order bucket and returns True if:
@@ -67,17 +144,20 @@ void UnificationTable::add_to_token_list(std::string_view variable_identifier, s
 // OR
 //     The intended placement of the element is 1, which makes it
 //         automatically valid
-bool UnificationTable::does_element_match_variable(std::string_view variable_identifier, size_t order, std::string_view token, uintptr_t address) const {
+bool UnificationTable::does_element_match_variable(size_t variable_identifier, size_t order, std::string_view token, uintptr_t address) const {
 
     // automatically valid
     if (order == 1)
         return true;
 
+    if (variable_identifier >= buckets.size() || buckets[variable_identifier].size() < order - 1)
+        return false;
+
     std::set<uintptr_t> chained_addresses{address};
-    const auto bucketVar = bucket.find(variable_identifier);
+    const auto& bucketVar = buckets[variable_identifier];
     for (size_t i = order - 1; i > 0; --i) {
         bool inserted = false;
-        for (const auto& prev_order_element : bucketVar->second.find(i)->second) {
+        for (const auto& prev_order_element : bucketVar[i - 1]) {
 
             if (token.data() == prev_order_element.token.data() && chained_addresses.emplace(prev_order_element.address).second) {
                 inserted = true;
@@ -92,11 +172,13 @@ bool UnificationTable::does_element_match_variable(std::string_view variable_ide
     return true;
 }
 
-bool UnificationTable::is_element_in_bucket(std::string_view variable_identifier, std::string_view t, uintptr_t address) const {
-    std::string token(t);
-    const auto bucketVar = bucket.find(variable_identifier);
-    for (size_t i = size_of_variable_bucket(variable_identifier); i > 0; --i) {
-        for (const auto& element : bucketVar->second.find(i)->second) {
+bool UnificationTable::is_element_in_bucket(size_t variable_identifier, std::string_view token, uintptr_t address) const {
+
+    if (variable_identifier >= buckets.size())
+        return false;
+
+    for (const auto& order : buckets[variable_identifier]) {
+        for (const auto& element : order) {
             if (token == element.token && address == element.address) {
                 return true;
             }
@@ -107,54 +189,68 @@ bool UnificationTable::is_element_in_bucket(std::string_view variable_identifier
 
 void UnificationTable::empty_buckets() {
 
-    for (auto& variable : bucket) {
-        for (auto& order : variable.second) {
-            order.second.clear();
+    for (auto& variable : buckets) {
+        for (auto& order : variable) {
+            order.clear();
         }
     }
 }
 
-void UnificationTable::empty_bucket(std::string_view variable_identifier) {
-    const auto it = bucket.find(variable_identifier);
-    if (it == bucket.end()) {
+void UnificationTable::empty_bucket(size_t variable_identifier) {
+
+    if (variable_identifier >= buckets.size()) {
         return;
     }
 
-    for (auto& orderFirst : it->second) {
-        orderFirst.second.clear();
+    for (auto& order : buckets[variable_identifier]) {
+        order.clear();
     }
 }
 
-void UnificationTable::add_regex_rule(std::string_view variable_identifier, std::string_view regex_string) {
-    std::string identifier = std::string(variable_identifier);
-    std::string rule(regex_string);
-    if (regex_rules.find(identifier) == regex_rules.end()) {
-        regex_rules.insert(std::make_pair(identifier, std::set<std::string>()));
-    }
-    auto& regex_list = regex_rules.find(identifier)->second;
-    regex_list.insert(rule);
+// Adds a regex rule to a variable. Rules are compiled once per thread,
+// and shared across units and queries.
+void UnificationTable::add_regex_rule(size_t variable_identifier, std::string_view regex_string) {
+
+    thread_local std::map<std::string, std::unique_ptr<regex_rule>, std::less<>> compiled;
+
+    auto it = compiled.find(regex_string);
+    if (it == compiled.end())
+        it = compiled.emplace(std::string(regex_string), std::make_unique<regex_rule>(regex_string)).first;
+
+    if (regex_rules.size() <= variable_identifier)
+        regex_rules.resize(variable_identifier + 1);
+
+    auto& rules = regex_rules[variable_identifier];
+    if (std::find(rules.begin(), rules.end(), it->second.get()) == rules.end())
+        rules.push_back(it->second.get());
 }
 
-bool UnificationTable::check_regex(std::string_view variable_identifier, std::string_view t) {
-    std::string identifier(variable_identifier);
-    std::string token(t);
-    if (regex_rules.find(identifier) == regex_rules.end()) {
+// Checks that the token matches all the regex rules of the variable
+bool UnificationTable::check_regex(size_t variable_identifier, std::string_view token) const {
+
+    if (variable_identifier >= regex_rules.size())
         return true;
-    }
-    for (const auto& rule : regex_rules.find(identifier)->second) {
-        if (!std::regex_match(token,std::regex(rule))) {
+
+    for (const auto rule : regex_rules[variable_identifier]) {
+        if (!rule->match(token))
             return false;
-        }
     }
     return true;
 }
 
+// Empties all variables and regex rules so the table can be reused
+void UnificationTable::clear() {
+
+    buckets.clear();
+    regex_rules.clear();
+}
+
 std::ostream& operator<<(std::ostream& out, const UnificationTable& storage) {
-    for (auto const& variable : storage.bucket) {
-        out << variable.first << std::endl;
-        for (auto const& order : variable.second) {
-            out << "\t" << order.first << std::endl;
-            for (const auto& element : order.second) {
+    for (size_t variable = 0; variable < storage.buckets.size(); ++variable) {
+        out << variable << std::endl;
+        for (size_t order = 0; order < storage.buckets[variable].size(); ++order) {
+            out << "\t" << (order + 1) << std::endl;
+            for (const auto& element : storage.buckets[variable][order]) {
                 out << "\t\t" << element.token << " | " << element.address << std::endl;
             }
         }
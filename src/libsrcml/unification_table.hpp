@@ -24,39 +24,58 @@ struct unique_element {
     std::uintptr_t address;
 };
 
+// A regex rule compiled once. Patterns that are a literal, or a literal with a
+// leading and/or trailing .*, are matched with string operations in linear time.
+// All others use std::regex.
+class regex_rule {
+public:
+    explicit regex_rule(std::string_view pattern);
+
+    bool match(std::string_view token) const;
+
+private:
+    enum { LITERAL, PREFIX, SUFFIX, CONTAINS, REGEX, INVALID } kind = REGEX;
+    std::string literal;
+    std::regex regex;
+};
+
 using token_list = std::vector<unique_element>;
-using number_bucket = std::unordered_map<size_t, token_list>;
-using variable_bucket = std::map<std::string, number_bucket, std::less<>>;
 
+// token lists of a variable, indexed by order - 1
+using number_bucket = std::vector<token_list>;
+
+// Variables are small integer ids, interned from the variable names by
+// XPathGenerator, so the table is a set of flat vectors indexed by id
 class UnificationTable {
 public:
     UnificationTable() = default;
 
-    void add_to_variable_bucket(std::string_view);
+    void add_to_variable_bucket(size_t);
 
-    size_t size_of_variable_bucket(std::string_view) const;
+    size_t size_of_variable_bucket(size_t) const;
 
     bool will_unification_occur() const;
 
-    void add_to_number_bucket(std::string_view, size_t);
+    void add_to_number_bucket(size_t, size_t);
 
-    void add_to_token_list(std::string_view, size_t, std::string_view, std::uintptr_t);
+    void add_to_token_list(size_t, size_t, std::string_view, std::uintptr_t);
 
-    bool does_element_match_variable(std::string_view, size_t, std::string_view first, uintptr_t second) const;
-    bool is_element_in_bucket(std::string_view, std::string_view first, uintptr_t second) const;
+    bool does_element_match_variable(size_t, size_t, std::string_view first, uintptr_t second) const;
+    bool is_element_in_bucket(size_t, std::string_view first, uintptr_t second) const;
 
     void empty_buckets();
-    void empty_bucket(std::string_view);
+    void empty_bucket(size_t);
+
+    void add_regex_rule(size_t, std::string_view);
+    bool check_regex(size_t, std::string_view) const;
 
-    void add_regex_rule(std::string_view, std::string_view);
-    bool check_regex(std::string_view, std::string_view);
-    // void clear_storage();
+    void clear();
 
     friend std::ostream& operator<<(std::ostream&, const UnificationTable&);
 
 private:
-    variable_bucket bucket;
-    std::map<std::string,std::set<std::string>> regex_rules;
+    std::vector<number_bucket> buckets;
+    std::vector<std::vector<const regex_rule*>> regex_rules;
 };
 
 #endif
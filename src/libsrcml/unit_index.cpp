@@ -0,0 +1,1186 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file unit_index.cpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * Index of the byte positions of the units in a srcML archive.
+ *
+ * The index is built by a scan of the markup only, without parsing
+ * the XML, and can be stored in a sidecar file next to the archive.
+ */
+
+#include <unit_index.hpp>
+#include <srcmlns.hpp>
+#include <algorithm>
+#include <fstream>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+using namespace ::std::literals::string_literals;
+using namespace ::std::literals::string_view_literals;
+
+namespace {
+
+    // input read on demand, with absolute positions from the start of the input
+    class input_window {
+    public:
+
+        explicit input_window(const std::function<size_t(char*, size_t)>& read)
+            : read(read) {}
+
+        // position of the text at or after pos, or npos at end of input
+        size_t find(std::string_view text, size_t pos) {
+
+            size_t from = pos;
+            while (true) {
+
+                auto found = buffer.find(text, from - base);
+                if (found != std::string::npos)
+                    return base + found;
+
+                // only search the new input, allowing for a match across the boundary
+                const size_t end = base + buffer.size();
+                from = std::max(pos, end >= text.size() ? end - text.size() + 1 : base);
+
+                if (!more())
+                    return std::string::npos;
+            }
+        }
+
+        // character at pos, or 0 at end of input
+        char at(size_t pos) {
+
+            while (pos - base >= buffer.size()) {
+                if (!more())
+                    return 0;
+            }
+
+            return buffer[pos - base];
+        }
+
+        // already read text in the range [pos, end)
+        std::string_view text(size_t pos, size_t end) const {
+
+            return std::string_view(buffer).substr(pos - base, end - pos);
+        }
+
+        // input before pos is no longer needed
+        void discard(size_t pos) {
+
+            if (pos - base < DISCARD_SIZE)
+                return;
+
+            buffer.erase(0, pos - base);
+            base = pos;
+        }
+
+    private:
+        bool more() {
+
+            char chunk[CHUNK_SIZE];
+            const size_t count = read(chunk, sizeof(chunk));
+            if (count == 0)
+                return false;
+
+            buffer.append(chunk, count);
+
+            return true;
+        }
+
+        static const size_t CHUNK_SIZE = 16 * 1024;
+        static const size_t DISCARD_SIZE = 1024 * 1024;
+
+        const std::function<size_t(char*, size_t)>& read;
+        std::string buffer;
+        size_t base = 0;
+    };
+
+    // append the UTF-8 encoding of a character code
+    void append_utf8(std::string& s, unsigned long code) {
+
+        if (code < 0x80) {
+            s += (char) code;
+        } else if (code < 0x800) {
+            s += (char) (0xC0 | (code >> 6));
+            s += (char) (0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            s += (char) (0xE0 | (code >> 12));
+            s += (char) (0x80 | ((code >> 6) & 0x3F));
+            s += (char) (0x80 | (code & 0x3F));
+        } else {
+            s += (char) (0xF0 | (code >> 18));
+            s += (char) (0x80 | ((code >> 12) & 0x3F));
+            s += (char) (0x80 | ((code >> 6) & 0x3F));
+            s += (char) (0x80 | (code & 0x3F));
+        }
+    }
+
+    // replace entity and character references
+    std::string unescape(std::string_view value) {
+
+        std::string result;
+        result.reserve(value.size());
+        for (size_t pos = 0; pos < value.size(); ++pos) {
+
+            const size_t semicolon = value[pos] == '&' ? value.find(';', pos) : std::string_view::npos;
+            if (semicolon == std::string_view::npos) {
+                result += value[pos];
+                continue;
+            }
+
+            const std::string_view entity = value.substr(pos + 1, semicolon - pos - 1);
+            if (entity == "lt"sv)
+                result += '<';
+            else if (entity == "gt"sv)
+                result += '>';
+            else if (entity == "amp"sv)
+                result += '&';
+            else if (entity == "quot"sv)
+                result += '"';
+            else if (entity == "apos"sv)
+                result += '\'';
+            else if (entity.size() > 1 && entity[0] == '#') {
+                const bool hex = entity[1] == 'x' || entity[1] == 'X';
+                const std::string digits(entity.substr(hex ? 2 : 1));
+                append_utf8(result, strtoul(digits.data(), nullptr, hex ? 16 : 10));
+            } else
+                result += value.substr(pos, semicolon - pos + 1);
+
+            pos = semicolon;
+        }
+
+        return result;
+    }
+
+    // escape the characters that separate the fields and lines of an index file
+    std::string escape(std::string_view value) {
+
+        std::string result;
+        result.reserve(value.size());
+        for (const char c : value) {
+            switch (c) {
+            case '&':  result += "&amp;"; break;
+            case '\t': result += "&#9;"; break;
+            case '\n': result += "&#10;"; break;
+            case '\r': result += "&#13;"; break;
+            default:   result += c;
+            }
+        }
+
+        return result;
+    }
+
+    // qualified name of the element of a start tag
+    std::string_view qualified_name(std::string_view tag) {
+
+        const auto end = tag.find_first_of(" \t\r\n/>", 1);
+
+        return tag.substr(1, end - 1);
+    }
+
+    // local name of the element of a start tag
+    std::string_view local_name(std::string_view tag) {
+
+        const std::string_view qname = qualified_name(tag);
+        const auto colon = qname.find(':');
+
+        return colon == std::string_view::npos ? qname : qname.substr(colon + 1);
+    }
+
+    // call the visitor with the qualified name and escaped value of each attribute in a start tag
+    void for_each_attribute(std::string_view tag, const std::function<void(std::string_view, std::string_view)>& visit) {
+
+        auto pos = tag.find_first_of(" \t\r\n");
+        while (pos != std::string_view::npos) {
+
+            pos = tag.find_first_not_of(" \t\r\n", pos);
+            const auto equal = tag.find('=', pos);
+            if (pos == std::string_view::npos || equal == std::string_view::npos)
+                break;
+
+            auto attribute = tag.substr(pos, equal - pos);
+            attribute = attribute.substr(0, attribute.find_last_not_of(" \t\r\n") + 1);
+
+            const auto open = tag.find_first_of("\"'", equal);
+            if (open == std::string_view::npos)
+                break;
+            const auto close = tag.find(tag[open], open + 1);
+            if (close == std::string_view::npos)
+                break;
+
+            visit(attribute, tag.substr(open + 1, close - open - 1));
+
+            pos = close + 1;
+        }
+    }
+
+    // unescaped value of an attribute without a prefix in a start tag
+    std::string attribute_value(std::string_view tag, std::string_view name) {
+
+        std::string value;
+        for_each_attribute(tag, [&](std::string_view attribute, std::string_view escaped) {
+            if (attribute == name)
+                value = unescape(escaped);
+        });
+
+        return value;
+    }
+
+    // unit entry for the unit start tag
+    unit_index_entry entry(std::string_view tag, size_t offset) {
+
+        unit_index_entry entry;
+        entry.offset = offset;
+        entry.filename = attribute_value(tag, "filename"sv);
+        entry.language = attribute_value(tag, "language"sv);
+        entry.hash = attribute_value(tag, "hash"sv);
+
+        return entry;
+    }
+
+    // namespace of a standard XPath prefix
+    std::string_view standard_uri(std::string_view prefix) {
+
+        if (prefix == "src"sv)
+            return SRCML_SRC_NS_URI;
+
+        for (const auto& ns : default_namespaces) {
+            if (!ns.prefix.empty() && ns.prefix == prefix)
+                return ns.uri;
+        }
+
+        return ""sv;
+    }
+
+    // replace line endings and, for attribute values, whitespace, as an XML parser does
+    std::string normalize(std::string_view value, bool attribute) {
+
+        std::string result;
+        result.reserve(value.size());
+        for (size_t pos = 0; pos < value.size(); ++pos) {
+            if (value[pos] == '\r' && pos + 1 < value.size() && value[pos + 1] == '\n')
+                continue;
+
+            if (value[pos] == '\r' || (attribute && (value[pos] == '\n' || value[pos] == '\t')))
+                result += attribute ? ' ' : '\n';
+            else
+                result += value[pos];
+        }
+
+        return result;
+    }
+
+    // terms of the units found by the scan of the markup
+    class term_collector {
+    public:
+
+        explicit term_collector(unit_term_index& index)
+            : index(index) {}
+
+        // start tag of the root, which is also the unit of a solitary unit
+        void start_root(std::string_view tag) {
+
+            root_prefixes.clear();
+            declare(tag, root_prefixes);
+            start_unit(tag);
+        }
+
+        // the root is an archive, so its terms are not for a unit
+        void root_is_archive() {
+
+            unit_terms.clear();
+            collecting = false;
+        }
+
+        // start tag of a unit
+        void start_unit(std::string_view tag) {
+
+            prefixes = root_prefixes;
+            declare(tag, prefixes);
+            unit_terms.clear();
+            elements.clear();
+            names.clear();
+            collecting = true;
+
+            element(tag);
+            attributes(tag);
+        }
+
+        // start tag of an element in a unit
+        void start_element(std::string_view tag, bool empty) {
+
+            if (!collecting)
+                return;
+
+            // prefixes are only resolved with the declarations of the root and unit
+            std::unordered_map<std::string, std::string> declared;
+            declare(tag, declared);
+            if (!declared.empty())
+                valid = false;
+
+            const bool name = element(tag);
+            attributes(tag);
+
+            if (empty) {
+                if (name)
+                    add("n");
+                return;
+            }
+
+            elements.push_back(name);
+            if (name)
+                names.emplace_back();
+        }
+
+        // end tag of an element in a unit
+        void end_element() {
+
+            if (!collecting || elements.empty())
+                return;
+
+            if (elements.back()) {
+                add("n" + names.back());
+                names.pop_back();
+            }
+            elements.pop_back();
+        }
+
+        // escaped character data
+        void text(std::string_view escaped) {
+
+            if (!collecting || names.empty() || escaped.empty())
+                return;
+
+            const auto value = unescape(normalize(escaped, false));
+            for (auto& name : names)
+                name += value;
+        }
+
+        // content of a CDATA section
+        void cdata(std::string_view value) {
+
+            if (!collecting || names.empty())
+                return;
+
+            const auto normalized = normalize(value, false);
+            for (auto& name : names)
+                name += normalized;
+        }
+
+        // end tag of a unit, at the position in the archive starting at 0
+        void end_unit(size_t position) {
+
+            if (!collecting)
+                return;
+
+            for (const auto& term : unit_terms)
+                index.postings[term].push_back((std::uint32_t) position);
+            unit_terms.clear();
+            collecting = false;
+        }
+
+        /** if the terms can be indexed */
+        bool valid = true;
+
+    private:
+
+        // add the namespace declarations of a start tag to the prefixes
+        void declare(std::string_view tag, std::unordered_map<std::string, std::string>& declared) {
+
+            for_each_attribute(tag, [this, &declared](std::string_view attribute, std::string_view value) {
+                if (attribute != "xmlns"sv && attribute.substr(0, 6) != "xmlns:"sv)
+                    return;
+
+                const auto prefix = attribute.size() > 5 ? attribute.substr(6) : ""sv;
+                const auto uri = unescape(value);
+
+                // XPath prefixes are resolved as the standard ones
+                const auto standard = standard_uri(prefix);
+                if (!standard.empty() && standard != uri)
+                    valid = false;
+
+                declared[std::string(prefix)] = uri;
+            });
+        }
+
+        // add the element term for a start tag, and return if it is a src:name
+        bool element(std::string_view tag) {
+
+            const auto qname = qualified_name(tag);
+            const auto colon = qname.find(':');
+            const auto prefix = colon == std::string_view::npos ? ""sv : qname.substr(0, colon);
+            const auto local = colon == std::string_view::npos ? qname : qname.substr(colon + 1);
+
+            const auto found = prefixes.find(std::string(prefix));
+            if (found == prefixes.end() && !prefix.empty()) {
+                valid = false;
+                return false;
+            }
+            const std::string uri = found != prefixes.end() ? found->second : "";
+
+            add("e{"s.append(uri).append("}").append(local));
+
+            return uri == SRCML_SRC_NS_URI && local == "name"sv;
+        }
+
+        // add the attribute terms for the attributes without a prefix of a start tag
+        void attributes(std::string_view tag) {
+
+            for_each_attribute(tag, [this](std::string_view attribute, std::string_view value) {
+                if (attribute.find(':') == std::string_view::npos && attribute != "xmlns"sv)
+                    add("a"s.append(attribute).append("=").append(unescape(normalize(value, true))));
+            });
+        }
+
+        void add(std::string term) {
+
+            unit_terms.insert(std::move(term));
+        }
+
+        unit_term_index& index;
+        std::unordered_map<std::string, std::string> root_prefixes;
+        std::unordered_map<std::string, std::string> prefixes;
+        std::unordered_set<std::string> unit_terms;
+        bool collecting = false;
+
+        // open elements of the unit, and if each is a src:name
+        std::vector<bool> elements;
+
+        // text so far of the open src:name elements
+        std::vector<std::string> names;
+    };
+}
+
+/**
+ * unit_index_build
+ * @param read callback to read the next part of the srcML
+ * @param terms term index to build, if not null
+ *
+ * Scan the markup of the srcML for the positions of the units.
+ * The scan relies on the srcML being in an ASCII-compatible encoding,
+ * and fails for anything else, e.g., compressed srcML.
+ *
+ * The terms are element names, the text of src:name elements, and attribute
+ * values, with prefixes resolved by the declarations on the root and units.
+ * The term index is left empty if the srcML declares namespaces elsewhere,
+ * or declares a standard XPath prefix, e.g., cpp, for another namespace.
+ *
+ * @returns the index on success, and std::nullopt if the srcML cannot be indexed
+ */
+std::optional<unit_index> unit_index_build(const std::function<size_t(char*, size_t)>& read, unit_term_index* terms) {
+
+    input_window input(read);
+    unit_index index;
+
+    unit_term_index term_index;
+    std::optional<term_collector> collector;
+    if (terms)
+        collector.emplace(term_index);
+
+    // skip byte-order mark and leading whitespace
+    size_t pos = 0;
+    if (input.at(0) == '\xEF' && input.at(1) == '\xBB' && input.at(2) == '\xBF')
+        pos = 3;
+    while (input.at(pos) == ' ' || input.at(pos) == '\t' || input.at(pos) == '\r' || input.at(pos) == '\n')
+        ++pos;
+    if (input.at(pos) != '<')
+        return std::nullopt;
+
+    int depth = 0;
+    bool archive = false;
+    bool first_child = true;
+    bool in_unit = false;
+    std::optional<unit_index_entry> root;
+    while (true) {
+
+        input.discard(pos);
+
+        const auto text = pos;
+        pos = input.find("<"sv, pos);
+        if (pos == std::string::npos)
+            return std::nullopt;
+
+        if (collector)
+            collector->text(input.text(text, pos));
+
+        const char next = input.at(pos + 1);
+
+        // processing instructions, comments, CDATA, and DOCTYPE
+        if (next == '?' || next == '!') {
+
+            std::string_view close = "?>"sv;
+            if (next == '!')
+                close = input.at(pos + 2) == '-' ? "-->"sv : input.at(pos + 2) == '[' ? "]]>"sv : ">"sv;
+
+            const auto end = input.find(close, pos + 2);
+            if (end == std::string::npos)
+                return std::nullopt;
+
+            if (collector && close == "]]>"sv)
+                collector->cdata(input.text(pos + 9, end));
+
+            pos = end + close.size();
+            continue;
+        }
+
+        // end tags
+        if (next == '/') {
+
+            const auto end = input.find(">"sv, pos);
+            if (end == std::string::npos || depth == 0)
+                return std::nullopt;
+
+            --depth;
+            if (depth == 1 && in_unit) {
+
+                index.units.back().length = end + 1 - index.units.back().offset;
+                in_unit = false;
+                if (collector)
+                    collector->end_unit(index.units.size() - 1);
+
+            } else if (depth == 0) {
+
+                if (archive) {
+                    index.footer = input.text(pos, end + 1);
+                } else {
+                    root->length = end + 1 - root->offset;
+                    index.units.push_back(*root);
+                    if (collector)
+                        collector->end_unit(0);
+                }
+
+                break;
+
+            } else if (collector) {
+
+                collector->end_element();
+            }
+
+            pos = end + 1;
+            continue;
+        }
+
+        // start tags, where attribute values may contain a '>'
+        auto end = pos + 1;
+        for (char quote = 0, c = 0; (c = input.at(end)) != '>' || quote; ++end) {
+            if (c == 0)
+                return std::nullopt;
+            if (quote && c == quote)
+                quote = 0;
+            else if (!quote && (c == '"' || c == '\''))
+                quote = c;
+        }
+        const bool empty = input.at(end - 1) == '/';
+        const auto tag = input.text(pos, end + 1);
+
+        if (depth == 0) {
+
+            // until a nested unit is found, assume a solitary unit
+            root = entry(tag, pos);
+            index.header_length = end + 1;
+            if (collector)
+                collector->start_root(tag);
+
+            if (empty) {
+                if (!root->language.empty()) {
+                    root->length = end + 1 - root->offset;
+                    index.header_length = root->offset;
+                    index.units.push_back(*root);
+                    if (collector)
+                        collector->end_unit(0);
+                }
+                break;
+            }
+
+        } else if (depth == 1 && (first_child || archive)) {
+
+            if (first_child)
+                archive = local_name(tag) == "unit"sv;
+            first_child = false;
+
+            if (archive && local_name(tag) == "unit"sv) {
+                index.units.push_back(entry(tag, pos));
+                if (empty)
+                    index.units.back().length = end + 1 - pos;
+                in_unit = !empty;
+
+                if (collector) {
+                    collector->root_is_archive();
+                    collector->start_unit(tag);
+                    if (empty)
+                        collector->end_unit(index.units.size() - 1);
+                }
+
+            } else if (collector) {
+
+                collector->start_element(tag, empty);
+            }
+
+        } else if (collector) {
+
+            collector->start_element(tag, empty);
+        }
+
+        if (!empty)
+            ++depth;
+
+        pos = end + 1;
+    }
+
+    // a solitary unit is read with only what precedes it
+    if (!archive && root)
+        index.header_length = root->offset;
+
+    // the size of the input is needed to detect a stale index
+    index.size = pos;
+    while (input.at(index.size))
+        ++index.size;
+
+    if (collector && collector->valid) {
+        term_index.size = index.size;
+        term_index.units = index.units.size();
+        *terms = std::move(term_index);
+    }
+
+    return index;
+}
+
+/**
+ * unit_index_filename
+ * @param srcml_filename name of a srcML file
+ *
+ * @returns the name of the sidecar index file for the srcML file
+ */
+std::string unit_index_filename(std::string_view srcml_filename) {
+
+    std::string index_filename(srcml_filename);
+    index_filename += ".idx";
+
+    return index_filename;
+}
+
+/**
+ * unit_index_read
+ * @param index_filename name of an index file
+ *
+ * @returns the index on success, and std::nullopt if the file does not exist or is not an index
+ */
+std::optional<unit_index> unit_index_read(const char* index_filename) {
+
+    std::ifstream in(index_filename, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+
+    std::string line;
+    if (!std::getline(in, line) || line != "srcml-index 3"sv)
+        return std::nullopt;
+
+    unit_index index;
+    while (std::getline(in, line)) {
+
+        // tab-separated fields
+        std::vector<std::string_view> fields;
+        std::string_view rest(line);
+        for (auto tab = rest.find('\t'); tab != std::string_view::npos; tab = rest.find('\t')) {
+            fields.push_back(rest.substr(0, tab));
+            rest.remove_prefix(tab + 1);
+        }
+        fields.push_back(rest);
+
+        if (fields[0] == "size"sv && fields.size() == 2) {
+            index.size = strtoull(std::string(fields[1]).data(), nullptr, 10);
+        } else if (fields[0] == "mtime"sv && fields.size() == 2) {
+            index.mtime = strtoll(std::string(fields[1]).data(), nullptr, 10);
+        } else if (fields[0] == "inode"sv && fields.size() == 2) {
+            index.inode = strtoull(std::string(fields[1]).data(), nullptr, 10);
+        } else if (fields[0] == "header"sv && fields.size() == 2) {
+            index.header_length = strtoull(std::string(fields[1]).data(), nullptr, 10);
+        } else if (fields[0] == "footer"sv && fields.size() == 2) {
+            index.footer = unescape(fields[1]);
+        } else if (fields[0] == "unit"sv && fields.size() == 6) {
+            unit_index_entry entry;
+            entry.offset = strtoull(std::string(fields[1]).data(), nullptr, 10);
+            entry.length = strtoull(std::string(fields[2]).data(), nullptr, 10);
+            entry.language = unescape(fields[3]);
+            entry.hash = unescape(fields[4]);
+            entry.filename = unescape(fields[5]);
+            index.units.push_back(entry);
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * unit_index_write
+ * @param index a unit index
+ * @param index_filename name of the index file
+ *
+ * Write the index as lines of tab-separated fields.
+ *
+ * @returns true on success, false on failure
+ */
+bool unit_index_write(const unit_index& index, const char* index_filename) {
+
+    std::ofstream out(index_filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    out << "srcml-index 3\n";
+    out << "size\t" << index.size << '\n';
+    out << "mtime\t" << index.mtime << '\n';
+    out << "inode\t" << index.inode << '\n';
+    out << "header\t" << index.header_length << '\n';
+    out << "footer\t" << escape(index.footer) << '\n';
+    for (const auto& entry : index.units) {
+        out << "unit\t" << entry.offset << '\t' << entry.length << '\t'
+            << escape(entry.language) << '\t' << escape(entry.hash) << '\t' << escape(entry.filename) << '\n';
+    }
+
+    return bool(out);
+}
+
+/**
+ * unit_term_index_filename
+ * @param srcml_filename name of a srcML file
+ *
+ * @returns the name of the sidecar term index file for the srcML file
+ */
+std::string unit_term_index_filename(std::string_view srcml_filename) {
+
+    std::string index_filename(srcml_filename);
+    index_filename += ".tidx";
+
+    return index_filename;
+}
+
+/**
+ * unit_term_index_read
+ * @param index_filename name of a term index file
+ *
+ * @returns the term index on success, and std::nullopt if the file does not exist or is not a term index
+ */
+std::optional<unit_term_index> unit_term_index_read(const char* index_filename) {
+
+    std::ifstream in(index_filename, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+
+    std::string line;
+    if (!std::getline(in, line) || line != "srcml-term-index 3"sv)
+        return std::nullopt;
+
+    unit_term_index index;
+    while (std::getline(in, line)) {
+
+        const auto tab = line.find('\t');
+        if (tab == std::string::npos)
+            return std::nullopt;
+        const std::string_view field(line.data(), tab);
+        const char* value = line.data() + tab + 1;
+
+        if (field == "size"sv) {
+            index.size = strtoull(value, nullptr, 10);
+        } else if (field == "mtime"sv) {
+            index.mtime = strtoll(value, nullptr, 10);
+        } else if (field == "inode"sv) {
+            index.inode = strtoull(value, nullptr, 10);
+        } else if (field == "units"sv) {
+            index.units = strtoull(value, nullptr, 10);
+        } else if (field == "term"sv) {
+
+            // term, and the differences between the ascending unit positions
+            const char* positions = strchr(value, '\t');
+            if (!positions)
+                return std::nullopt;
+
+            auto& posting = index.postings[unescape(std::string_view(value, (size_t) (positions - value)))];
+            std::uint32_t position = 0;
+            for (char* next = (char*) positions + 1; *next; ) {
+                position += (std::uint32_t) strtoul(next, &next, 10);
+                posting.push_back(position);
+            }
+
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * unit_term_index_write
+ * @param index a term index
+ * @param index_filename name of the term index file
+ *
+ * Write the term index as lines of tab-separated fields, with the terms
+ * sorted, and each list of unit positions as differences.
+ *
+ * @returns true on success, false on failure
+ */
+bool unit_term_index_write(const unit_term_index& index, const char* index_filename) {
+
+    std::ofstream out(index_filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    std::vector<const std::pair<const std::string, std::vector<std::uint32_t>>*> postings;
+    postings.reserve(index.postings.size());
+    for (const auto& posting : index.postings)
+        postings.push_back(&posting);
+    std::sort(postings.begin(), postings.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    out << "srcml-term-index 3\n";
+    out << "size\t" << index.size << '\n';
+    out << "mtime\t" << index.mtime << '\n';
+    out << "inode\t" << index.inode << '\n';
+    out << "units\t" << index.units << '\n';
+    for (const auto* posting : postings) {
+
+        out << "term\t" << escape(posting->first) << '\t';
+        std::uint32_t previous = 0;
+        for (const auto position : posting->second) {
+            if (position != posting->second.front())
+                out << ' ';
+            out << position - previous;
+            previous = position;
+        }
+        out << '\n';
+    }
+
+    return bool(out);
+}
+
+namespace {
+
+    void skip_space(std::string_view& s) {
+
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r' || s.front() == '\n'))
+            s.remove_prefix(1);
+    }
+
+    bool starts_with(std::string_view s, std::string_view prefix) {
+
+        return s.substr(0, prefix.size()) == prefix;
+    }
+
+    // XML name without a colon, or empty if none
+    std::string_view parse_ncname(std::string_view& s) {
+
+        size_t end = 0;
+        while (end < s.size()) {
+            const unsigned char c = (unsigned char) s[end];
+            if (!(std::isalpha(c) || c == '_' || c >= 0x80 || (end > 0 && (std::isdigit(c) || c == '-' || c == '.'))))
+                break;
+            ++end;
+        }
+
+        const auto name = s.substr(0, end);
+        s.remove_prefix(end);
+
+        return name;
+    }
+
+    // string literal, or std::nullopt if none
+    std::optional<std::string> parse_literal(std::string_view& s) {
+
+        if (s.empty() || (s.front() != '\'' && s.front() != '"'))
+            return std::nullopt;
+
+        const auto close = s.find(s.front(), 1);
+        if (close == std::string_view::npos)
+            return std::nullopt;
+
+        std::string literal(s.substr(1, close - 1));
+        s.remove_prefix(close + 1);
+
+        return literal;
+    }
+
+    // text of a predicate, or std::nullopt if not closed
+    std::optional<std::string_view> parse_predicate(std::string_view& s) {
+
+        int depth = 0;
+        for (size_t pos = 0; pos < s.size(); ++pos) {
+
+            if (s[pos] == '\'' || s[pos] == '"') {
+                pos = s.find(s[pos], pos + 1);
+                if (pos == std::string_view::npos)
+                    return std::nullopt;
+            } else if (s[pos] == '[') {
+                ++depth;
+            } else if (s[pos] == ']' && --depth == 0) {
+                const auto predicate = s.substr(1, pos - 1);
+                s.remove_prefix(pos + 1);
+                return predicate;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // element term for a name test, or empty when the prefix is not a standard one
+    std::string element_term(std::string_view prefix, std::string_view local) {
+
+        const auto uri = standard_uri(prefix);
+        if (!prefix.empty() && uri.empty())
+            return "";
+
+        return "e{"s.append(uri).append("}").append(local);
+    }
+
+    const std::string name_term = element_term("src"sv, "name"sv);
+
+    // qualified name test, with the prefix and local name, or false if none
+    bool parse_qname(std::string_view& s, std::string_view& prefix, std::string_view& local) {
+
+        prefix = ""sv;
+        local = parse_ncname(s);
+        if (local.empty())
+            return false;
+
+        if (starts_with(s, ":"sv) && !starts_with(s, "::"sv)) {
+            s.remove_prefix(1);
+            prefix = local;
+            local = parse_ncname(s);
+            if (local.empty())
+                return false;
+        }
+
+        return true;
+    }
+
+    // terms of a predicate, for the forms [@a='v'], [e], [e='v'], and for src:name, [.='v']
+    // other predicates only filter the results further, so add no terms
+    void predicate_terms(std::string_view s, const std::string& step_term, std::vector<std::string>& terms) {
+
+        skip_space(s);
+        while (!s.empty() && std::isspace((unsigned char) s.back()))
+            s.remove_suffix(1);
+
+        // value compared to the predicate, if any, as the rest of the predicate
+        const auto compared = [](std::string_view s) -> std::optional<std::string> {
+            skip_space(s);
+            if (!starts_with(s, "="sv))
+                return std::nullopt;
+            s.remove_prefix(1);
+            skip_space(s);
+            auto literal = parse_literal(s);
+            return literal && s.empty() ? literal : std::nullopt;
+        };
+
+        if (starts_with(s, "@"sv)) {
+
+            s.remove_prefix(1);
+            const auto name = parse_ncname(s);
+            if (name.empty() || starts_with(s, ":"sv))
+                return;
+
+            if (const auto value = compared(s))
+                terms.push_back("a"s.append(name).append("=").append(*value));
+
+            return;
+        }
+
+        if (starts_with(s, "."sv) && !starts_with(s, ".."sv) && !starts_with(s, "./"sv)) {
+
+            s.remove_prefix(1);
+            if (const auto value = compared(s); value && step_term == name_term)
+                terms.push_back("n" + *value);
+
+            return;
+        }
+
+        std::string_view prefix, local;
+        if (!parse_qname(s, prefix, local))
+            return;
+
+        const auto term = element_term(prefix, local);
+        if (term.empty())
+            return;
+
+        skip_space(s);
+        if (s.empty()) {
+            terms.push_back(term);
+        } else if (const auto value = compared(s)) {
+            terms.push_back(term);
+            if (term == name_term)
+                terms.push_back("n" + *value);
+        }
+    }
+
+    // terms of a location step, or false if the step is not understood
+    bool step_terms(std::string_view& s, std::vector<std::string>& terms) {
+
+        skip_space(s);
+
+        std::string step_term;
+        if (starts_with(s, ".."sv)) {
+            s.remove_prefix(2);
+        } else if (starts_with(s, "."sv)) {
+            s.remove_prefix(1);
+        } else {
+
+            // attribute and namespace nodes do not have element names
+            bool element = true;
+            if (starts_with(s, "@"sv)) {
+                s.remove_prefix(1);
+                element = false;
+            } else {
+                auto rest = s;
+                const auto axis = parse_ncname(rest);
+                skip_space(rest);
+                if (!axis.empty() && starts_with(rest, "::"sv)) {
+                    static const std::string_view element_axes[] = {
+                        "ancestor"sv, "ancestor-or-self"sv, "child"sv, "descendant"sv, "descendant-or-self"sv,
+                        "following"sv, "following-sibling"sv, "parent"sv, "preceding"sv, "preceding-sibling"sv, "self"sv,
+                    };
+                    if (axis == "attribute"sv || axis == "namespace"sv)
+                        element = false;
+                    else if (std::find(std::begin(element_axes), std::end(element_axes), axis) == std::end(element_axes))
+                        return false;
+
+                    rest.remove_prefix(2);
+                    skip_space(rest);
+                    s = rest;
+                }
+            }
+
+            std::string_view prefix, local;
+            if (starts_with(s, "*"sv)) {
+                s.remove_prefix(1);
+            } else if (auto rest = s; parse_ncname(rest).size() && starts_with(rest, ":*"sv)) {
+                s = rest.substr(2);
+            } else if (parse_qname(s, prefix, local)) {
+
+                // node type tests, but not function calls
+                auto rest = s;
+                skip_space(rest);
+                if (starts_with(rest, "("sv)) {
+                    if (!prefix.empty() || (local != "node"sv && local != "text"sv && local != "comment"sv && local != "processing-instruction"sv))
+                        return false;
+                    rest.remove_prefix(1);
+                    skip_space(rest);
+                    parse_literal(rest);
+                    skip_space(rest);
+                    if (!starts_with(rest, ")"sv))
+                        return false;
+                    s = rest.substr(1);
+                } else if (element) {
+                    step_term = element_term(prefix, local);
+                    if (!step_term.empty())
+                        terms.push_back(step_term);
+                }
+            } else {
+                return false;
+            }
+        }
+
+        skip_space(s);
+        while (starts_with(s, "["sv)) {
+            const auto predicate = parse_predicate(s);
+            if (!predicate)
+                return false;
+            predicate_terms(*predicate, step_term, terms);
+            skip_space(s);
+        }
+
+        return true;
+    }
+}
+
+/**
+ * unit_index_query_terms
+ * @param xpath an XPath expression
+ *
+ * Determine the terms that a unit must contain for the XPath to have a result,
+ * for expressions that are a location path, or count() or boolean() of one.
+ * Each element name test of a step is a term, as are the simple predicates
+ * [@a='v'], [e], [e='v'], and for src:name, [.='v']. Other predicates only
+ * filter the results further, and are ignored. Prefixes are resolved as the
+ * standard XPath prefixes, e.g., src and cpp.
+ *
+ * @returns the query terms, or std::nullopt if the terms cannot be determined
+ */
+std::optional<unit_index_query> unit_index_query_terms(std::string_view xpath) {
+
+    unit_index_query query;
+
+    skip_space(xpath);
+    while (!xpath.empty() && std::isspace((unsigned char) xpath.back()))
+        xpath.remove_suffix(1);
+
+    // scalar wrappers of the location path
+    for (const auto& wrapper : { std::make_pair("count"sv, unit_index_query::COUNT), std::make_pair("boolean"sv, unit_index_query::BOOLEAN) }) {
+
+        auto rest = xpath;
+        if (!starts_with(rest, wrapper.first))
+            continue;
+        rest.remove_prefix(wrapper.first.size());
+        skip_space(rest);
+        if (!starts_with(rest, "("sv) || rest.back() != ')')
+            continue;
+
+        query.type = wrapper.second;
+        xpath = rest.substr(1, rest.size() - 2);
+        break;
+    }
+
+    // location path
+    skip_space(xpath);
+    if (starts_with(xpath, "/"sv))
+        xpath.remove_prefix(starts_with(xpath, "//"sv) ? 2 : 1);
+
+    std::vector<std::string> terms;
+    while (!xpath.empty()) {
+
+        if (!step_terms(xpath, terms))
+            return std::nullopt;
+
+        skip_space(xpath);
+        if (xpath.empty())
+            break;
+
+        if (!starts_with(xpath, "/"sv))
+            return std::nullopt;
+        xpath.remove_prefix(starts_with(xpath, "//"sv) ? 2 : 1);
+    }
+
+    if (terms.empty())
+        return std::nullopt;
+
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    query.terms = std::move(terms);
+
+    return query;
+}
+
+/**
+ * unit_term_index_contains
+ * @param index a term index
+ * @param position position of a unit, starting at 0
+ * @param query terms of a query
+ *
+ * @returns true if the unit contains all the terms of the query, or is not in the index
+ */
+bool unit_term_index_contains(const unit_term_index& index, size_t position, const unit_index_query& query) {
+
+    if (position >= index.units)
+        return true;
+
+    for (const auto& term : query.terms) {
+
+        const auto posting = index.postings.find(term);
+        if (posting == index.postings.end() || !std::binary_search(posting->second.begin(), posting->second.end(), (std::uint32_t) position))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file unit_index.hpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * Index of the byte positions of the units in a srcML archive
+ * for random access to a unit without reading the preceding units,
+ * and an optional index of the terms in each unit for pruning queries.
+ */
+
+#ifndef INCLUDED_UNIT_INDEX_HPP
+#define INCLUDED_UNIT_INDEX_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+// position and key attributes of a single unit
+struct unit_index_entry {
+
+    /** byte offset of the unit start tag */
+    size_t offset = 0;
+
+    /** byte length of the unit, including the end tag */
+    size_t length = 0;
+
+    std::string filename;
+    std::string language;
+    std::string hash;
+};
+
+// positions of all units in a srcML archive
+struct unit_index {
+
+    /** size of the indexed archive, to detect a stale index */
+    size_t size = 0;
+
+    /** modification time in nanoseconds and file serial number of the indexed archive, to detect a stale index of the same size */
+    std::int64_t mtime = 0;
+    std::uint64_t inode = 0;
+
+    /** length of the xml declaration and root start tag that precede the units */
+    size_t header_length = 0;
+
+    /** root end tag, empty for a solitary unit */
+    std::string footer;
+
+    std::vector<unit_index_entry> units;
+};
+
+// units that contain each term, by the position of the unit starting at 0
+// terms are element names, e{uri}name, the text of src:name elements, ntext,
+// and attributes without a prefix, aname=value
+struct unit_term_index {
+
+    /** size of the indexed archive, to detect a stale index */
+    size_t size = 0;
+
+    /** modification time in nanoseconds and file serial number of the indexed archive, to detect a stale index */
+    std::int64_t mtime = 0;
+    std::uint64_t inode = 0;
+
+    /** number of indexed units */
+    size_t units = 0;
+
+    /** ascending positions of the units with the term */
+    std::unordered_map<std::string, std::vector<std::uint32_t>> postings;
+};
+
+// terms a unit must contain for a query to have a result
+struct unit_index_query {
+
+    enum query_type { NODES, COUNT, BOOLEAN };
+
+    query_type type = NODES;
+    std::vector<std::string> terms;
+};
+
+// Scan the srcML from the read callback for the positions of the units, and the terms when requested
+std::optional<unit_index> unit_index_build(const std::function<size_t(char*, size_t)>& read, unit_term_index* terms = nullptr);
+
+// Sidecar index file for a srcML file
+std::string unit_index_filename(std::string_view srcml_filename);
+
+// Read and write an index file
+std::optional<unit_index> unit_index_read(const char* index_filename);
+bool unit_index_write(const unit_index& index, const char* index_filename);
+
+// Sidecar term index file for a srcML file
+std::string unit_term_index_filename(std::string_view srcml_filename);
+
+// Read and write a term index file
+std::optional<unit_term_index> unit_term_index_read(const char* index_filename);
+bool unit_term_index_write(const unit_term_index& index, const char* index_filename);
+
+// Terms required by an XPath, or std::nullopt if they cannot be determined
+std::optional<unit_index_query> unit_index_query_terms(std::string_view xpath);
+
+// If the unit at the position contains all of the terms of the query
+bool unit_term_index_contains(const unit_term_index& index, size_t position, const unit_index_query& query);
+
+#endif
@@ -11,6 +11,7 @@
 #include <libxml/parserInternals.h>
 #include <stack>
 #include <cstring>
+#include <vector>
 #include <string_view>
 
 using namespace ::std::literals::string_view_literals;
@@ -48,69 +49,106 @@ void unit_update_attributes(srcml_unit* unit, int num_attributes, const xmlChar*
     }
 }
 
+// Clear the parts of the srcml of the unit found so far, when the srcml changes
+void unit_reset_srcml_parts(srcml_unit* unit) {
+
+    unit->srcml_revision.reset();
+    unit->currevision = -1;
+    unit->srcml_revision_ranges.reset();
+    unit->srcml_fragment.reset();
+    unit->srcml_fragment_revision.reset();
+    unit->srcml_raw.reset();
+    unit->srcml_raw_revision.reset();
+}
+
 #undef DELETE
 
 enum { INSERT, DELETE, COMMON };
 
-std::string extract_revision(const char* srcml, int size, int revision, bool text_only) {
+// Ranges of the srcml in the original and modified srcdiff revisions, in a single scan
+std::array<revision_ranges, 2> extract_revision_ranges(std::string_view srcml) {
 
     std::string_view DIFF_PREFIX = "diff:"sv;
 
-    std::stack<int> mode;
-    mode.push(COMMON);
+    std::array<revision_ranges, 2> ranges;
+
+    // add a range to the revisions of the current mode, extending the last range when adjacent
+    std::vector<int> mode = { COMMON };
+    auto add = [&](std::size_t begin, std::size_t end) {
+
+        if (begin == end)
+            return;
 
-    std::string news;
-    const char* p = srcml;
-    const char* lastp = p;
-    while ((p = (const char*) memchr(p, '<', static_cast<size_t>(size - (p - srcml))))) {
+        for (int revision = 0; revision < 2; ++revision) {
 
-        bool inmode = mode.top() == COMMON || (revision == 0 && mode.top() == DELETE) || (revision == 1 && mode.top() == INSERT);
+            if (!(mode.back() == COMMON || (revision == 0 && mode.back() == DELETE) || (revision == 1 && mode.back() == INSERT)))
+                continue;
 
-        // output previous non-tag text
-        if (inmode) {
-            news.append(lastp, static_cast<size_t>(p - lastp));
+            auto& rranges = ranges[(std::size_t) revision];
+            if (!rranges.empty() && rranges.back().second == begin)
+                rranges.back().second = end;
+            else
+                rranges.emplace_back(begin, end);
         }
+    };
+
+    std::size_t lastp = 0;
+    std::size_t p = 0;
+    while ((p = srcml.find('<', p)) != std::string_view::npos) {
+
+        // previous non-tag text
+        add(lastp, p);
 
         auto sp = p;
 
         // skip to end of tag
-        p = (const char*) memchr(p, '>', static_cast<size_t>(size - (p - srcml)));
+        p = srcml.find('>', p);
+        if (p == std::string_view::npos) {
+            p = sp;
+            break;
+        }
         ++p;
 
-        if (strncmp(sp + 1, DIFF_PREFIX.data(), DIFF_PREFIX.size()) == 0) {
-
-            const char* tstart = sp + 1 + DIFF_PREFIX.size();
+        std::string_view tag = srcml.substr(sp + 1, p - sp - 1);
+        if (tag.substr(0, DIFF_PREFIX.size()) == DIFF_PREFIX) {
 
-            if (strncmp(tstart, "delete", 6) == 0) {
-                mode.push(DELETE);
-            } else if (strncmp(tstart, "insert", 6) == 0) {
-                mode.push(INSERT);
-            } else if (strncmp(tstart, "ws", 2) != 0) {
-                mode.push(COMMON);
+            tag.remove_prefix(DIFF_PREFIX.size());
+            if (tag.substr(0, 6) == "delete"sv) {
+                mode.push_back(DELETE);
+            } else if (tag.substr(0, 6) == "insert"sv) {
+                mode.push_back(INSERT);
+            } else if (tag.substr(0, 2) != "ws"sv) {
+                mode.push_back(COMMON);
             }
 
-        }
-        else if (*(sp + 1) == '/' && strncmp(sp + 2, DIFF_PREFIX.data(), DIFF_PREFIX.size()) == 0) {
-            if(strncmp(sp + 2 + DIFF_PREFIX.size(), "ws", 2) != 0) {
-                mode.pop();
-            }
-        }
-        else {
-            if (inmode && !text_only) {
-                news.append(sp, static_cast<size_t>(p - sp));
-            }
+        } else if (tag.substr(0, 1 + DIFF_PREFIX.size()) == "/diff:"sv) {
+
+            if (tag.substr(1 + DIFF_PREFIX.size(), 2) != "ws"sv && mode.size() > 1)
+                mode.pop_back();
+
+        } else {
+            add(sp, p);
         }
 
         lastp = p;
     }
 
-    bool inmode = mode.top() == COMMON || (revision == 0 && mode.top() == DELETE) || (revision == 1 && mode.top() == INSERT);
-    auto remaining_size = (size_t) size - (size_t) (lastp - srcml);
-    if (inmode && remaining_size > 0) {
-        news.append(lastp, remaining_size);
-    }
+    add(lastp, srcml.size());
+
+    return ranges;
+}
+
+// Extract the srcml from begin to end that is in the revision ranges
+std::string extract_revision(std::string_view srcml, const revision_ranges& ranges, std::size_t begin, std::size_t end) {
+
+    std::size_t size = 0;
+    for_each_revision_range(srcml, ranges, begin, end, [&](std::string_view part) { size += part.size(); });
+
+    std::string s;
+    s.reserve(size);
+    for_each_revision_range(srcml, ranges, begin, end, [&](std::string_view part) { s.append(part); });
 
-    return news;
+    return s;
 }
 
 struct extract_context {
@@ -12,14 +12,39 @@
 
 #include <srcml_types.hpp>
 #include <libxml/parser.h>
+#include <algorithm>
+#include <array>
 #include <string_view>
 
 // Update unit attributes with xml parsed attributes
 void unit_update_attributes(srcml_unit* unit, int num_attributes, const xmlChar** attributes);
 
+// Clear the parts of the srcml of the unit found so far, when the srcml changes
+void unit_reset_srcml_parts(srcml_unit* unit);
+
 // Extract source code from srcml
 std::string extract_src(std::string_view srcml, std::optional<int> revision = std::nullopt);
-std::string extract_revision(const char* srcml, int size, int revision, bool text_only = false);
 std::string_view attribute_revision(std::string_view attribute, int revision);
 
+// Ranges of the srcml in the original and modified srcdiff revisions, in a single scan
+std::array<revision_ranges, 2> extract_revision_ranges(std::string_view srcml);
+
+// Call f with each part of the srcml from begin to end that is in the revision ranges
+template<typename F>
+void for_each_revision_range(std::string_view srcml, const revision_ranges& ranges, std::size_t begin, std::size_t end, F f) {
+
+    // first range that ends after the begin
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const std::pair<std::size_t, std::size_t>& range, std::size_t pos) {
+        return range.second <= pos;
+    });
+    for (; it != ranges.end() && it->first < end; ++it) {
+        const auto rbegin = std::max(it->first, begin);
+        const auto rend = std::min(it->second, end);
+        f(srcml.substr(rbegin, rend - rbegin));
+    }
+}
+
+// Extract the srcml from begin to end that is in the revision ranges
+std::string extract_revision(std::string_view srcml, const revision_ranges& ranges, std::size_t begin, std::size_t end);
+
 #endif
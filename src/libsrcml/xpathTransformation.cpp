@@ -56,6 +56,12 @@ xpathTransformation::xpathTransformation(srcml_archive* /* oarchive */, const ch
     // errors will show up when it is first used
     if (std::string_view(xpath).compare(0, "srcql:"sv.size(), "srcql:") != 0) {
         compiled_xpath = xmlXPathCompile(BAD_CAST xpath);
+
+        // results marked in the unit need the DOM
+        if (compiled_xpath && this->element.empty() && this->attr_name.empty()) {
+            streaming = xpath_stream::compile(xpath);
+            index_terms = unit_index_query_terms(xpath);
+        }
     }
 
     // create a namespace for the new attribute (if needed)
@@ -77,6 +83,12 @@ xpathTransformation::~xpathTransformation() {
     if (compiled_xpath)
         xmlXPathFreeCompExpr(compiled_xpath);
 
+    // free the compiled srcQL queries
+    for (const auto& compiled : srcql_compiled) {
+        if (compiled.second)
+            xmlXPathFreeCompExpr(compiled.second);
+    }
+
     // free the namespace for any added attributes
     if (attr_ns)
         xmlFreeNs(attr_ns);
@@ -166,92 +178,214 @@ void xpathTransformation::append_attribute_to_node(xmlNodePtr node, const char*
     xmlNewNsProp(node, attr_ns, (const xmlChar *) attr_name.data(), (const xmlChar *) newvalue);
 }
 
-xmlXPathContextPtr xpathTransformation::createContext(xmlDocPtr doc) const {
-
-    auto context = xmlXPathNewContext(doc);
-
-    return context;
-}
-#pragma GCC diagnostic push
-
 /**
- * apply
+ * createContext
+ * @param doc the document to evaluate on
+ * @param replaced prefixes registered from the document, with any previous namespace
  *
- * Apply XPath expression, writing results.
+ * The XPath context of the thread. The standard namespaces, the exslt set functions,
+ * and the srcQL extension functions are only registered when the context is created.
+ * Each use sets the document, registers the document namespaces, and empties the
+ * unification table. Call releaseContext() after evaluation.
  *
- * @returns true on success false on failure.
+ * @returns the context of the thread, or null on error.
  */
-TransformationResult xpathTransformation::apply(xmlDocPtr doc, int position) const {
+xmlXPathContextPtr xpathTransformation::createContext(xmlDocPtr doc, std::vector<std::pair<std::string, std::optional<std::string>>>& replaced) const {
 
+    thread_local std::unique_ptr<xmlXPathContext> context;
+    thread_local UnificationTable table;
 
-    std::unique_ptr<xmlXPathContext> context(xmlXPathNewContext(doc));
     if (!context) {
-        fprintf(stderr, "%s: Error in executing xpath\n", "libsrcml");
-        return TransformationResult();
-    }
 
-    // register standard prefixes for standard namespaces
-    for (const auto& ns : default_namespaces) {
+        context.reset(xmlXPathNewContext(nullptr));
+        if (!context)
+            return nullptr;
+
+        // register standard prefixes for standard namespaces
+        for (const auto& ns : default_namespaces) {
 
-        const char* registerURI = ns.uri.data();
-        const char* registerPrefix = ns.prefix.data();
-        if (ns.uri == SRCML_SRC_NS_URI)
-            registerPrefix = "src";
+            const char* registerURI = ns.uri.data();
+            const char* registerPrefix = ns.prefix.data();
+            if (ns.uri == SRCML_SRC_NS_URI)
+                registerPrefix = "src";
 
-        if (xmlXPathRegisterNs(context.get(), BAD_CAST registerPrefix, BAD_CAST registerURI) == -1) {
-            fprintf(stderr, "%s: Unable to register prefix '%s' for namespace %s\n", "libsrcml", registerPrefix, registerURI);
+            if (xmlXPathRegisterNs(context.get(), BAD_CAST registerPrefix, BAD_CAST registerURI) == -1) {
+                fprintf(stderr, "%s: Unable to register prefix '%s' for namespace %s\n", "libsrcml", registerPrefix, registerURI);
+            }
         }
+
+        // register exslt set functions for sets
+        exsltSetsXpathCtxtRegister (context.get(), BAD_CAST "set");
+
+        // register srcQL extension functions
+        // qli Namespace
+        xmlXPathRegisterNs(context.get(),(xmlChar*)"qli",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation");
+        // Unification Operations
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"add-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&add_element);
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"match-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&match_element);
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"clear",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&clear_elements);
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"is-valid-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&is_valid_element);
+        // WHERE Clause Functions
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"regex-match",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&regex_match);
+        // Debug
+        xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"debug-print",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&debug_print);
     }
 
-    // register exslt set functions for sets
-    exsltSetsXpathCtxtRegister (context.get(), BAD_CAST "set");
+    // same initial state as a new context
+    context->doc = doc;
+    context->node = nullptr;
+    context->contextSize = -1;
+    context->proximityPosition = -1;
 
-    // register prefixes from the doc
+    // register prefixes from the doc, saving any namespace they replace
+    replaced.clear();
     for (auto p = doc->children->nsDef; p; p = p->next) {
 
+        if (!p->prefix)
+            continue;
+
+        const xmlChar* previous = xmlXPathNsLookup(context.get(), p->prefix);
+        replaced.emplace_back((const char*) p->prefix, previous ? std::optional<std::string>((const char*) previous) : std::nullopt);
+
         xmlXPathRegisterNs(context.get(), p->prefix, p->href);
     }
 
-    // register srcQL extension functions
-    // qli Namespace
-    xmlXPathRegisterNs(context.get(),(xmlChar*)"qli",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation");
-    // Unification Operations
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"add-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&add_element);
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"match-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&match_element);
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"clear",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&clear_elements);
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"is-valid-element",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&is_valid_element);
-    // WHERE Clause Functions
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"regex-match",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&regex_match);
-    // Debug
-    xmlXPathRegisterFuncNS(context.get(), (const xmlChar*)"debug-print",(xmlChar*)"http://www.srcML.org/srcML/srcQLImplementation",&debug_print);
-
     // Add Unification Table to userData
-    UnificationTable* table = new UnificationTable();
-    context.get()->userData = (void*)(table);
-
-    auto localCompiledXPath = compiled_xpath;
-    bool is_srcql_query = false;
-    // process srcQL query
-    if (!localCompiledXPath) {
-        std::string_view srcql_string(xpath);
-        srcql_string.remove_prefix("srcql:"sv.size());
-        const auto srcqlXPath = srcql_convert_query_to_xpath(srcql_string.data(), Language(position).getLanguageString());
-        localCompiledXPath = xmlXPathCompile(BAD_CAST srcqlXPath);
-        delete[] srcqlXPath;
-        is_srcql_query = true;
+    table.clear();
+    context->userData = (void*)(&table);
+
+    return context.get();
+}
+
+/**
+ * releaseContext
+ * @param context the context of the thread
+ * @param replaced prefixes registered from the document, with any previous namespace
+ *
+ * Restore the context of the thread for the next document.
+ */
+void xpathTransformation::releaseContext(xmlXPathContextPtr context, const std::vector<std::pair<std::string, std::optional<std::string>>>& replaced) const {
+
+    // in reverse, in case the document declares the same prefix more than once
+    for (auto it = replaced.rbegin(); it != replaced.rend(); ++it) {
+        xmlXPathRegisterNs(context, BAD_CAST it->first.data(), it->second ? BAD_CAST it->second->data() : nullptr);
     }
 
-    // evaluate the xpath
-    std::unique_ptr<xmlXPathObject> result_nodes(xmlXPathCompiledEval(localCompiledXPath, context.get()));
+    context->doc = nullptr;
+    context->node = nullptr;
+    context->userData = nullptr;
+}
+
+/**
+ * compileSrcQL
+ * @param language the language of the unit
+ *
+ * Convert the srcQL query to XPath for the language and compile it.
+ * The compiled expression is cached, so each language is only compiled once.
+ *
+ * @returns the compiled XPath, or null if it does not compile.
+ */
+xmlXPathCompExprPtr xpathTransformation::compileSrcQL(int language) const {
+
+    // Shared lock for read
+    {
+        std::shared_lock lock(srcql_compiled_mutex);
+        if (auto search = srcql_compiled.find(language); search != srcql_compiled.end())
+            return search->second;
+    }
 
-    // free unification table after evaluation is done
-    delete table;
+    // Unique lock for write
+    std::unique_lock lock(srcql_compiled_mutex);
+    if (auto search = srcql_compiled.find(language); search != srcql_compiled.end())
+        return search->second;
+
+    std::string_view srcql_string(xpath);
+    srcql_string.remove_prefix("srcql:"sv.size());
+    const auto srcqlXPath = srcql_convert_query_to_xpath(srcql_string.data(), Language(language).getLanguageString());
+    auto compiled = xmlXPathCompile(BAD_CAST srcqlXPath);
+    srcql_terms.emplace(language, compiled ? unit_index_query_terms(srcqlXPath) : std::nullopt);
+    srcql_required.emplace(language, compiled ? srcql_query_features(srcql_string.data(), Language(language).getLanguageString()) : srcql_features());
+    delete[] srcqlXPath;
+
+    // failures are cached too, so errors are only reported once
+    if (!compiled)
+        fprintf(stderr, "%s: Unable to compile srcQL query for %s\n", "libsrcml", Language(language).getLanguageString());
+    srcql_compiled.emplace(language, compiled);
+
+    return compiled;
+}
+
+/**
+ * index_query
+ * @param language the language of the unit
+ *
+ * @returns the terms a unit must contain for a result, or null if they are not known
+ */
+const unit_index_query* xpathTransformation::index_query(int language) const {
+
+    if (!element.empty() || !attr_name.empty())
+        return nullptr;
+
+    if (compiled_xpath)
+        return index_terms ? &*index_terms : nullptr;
+
+    if (std::string_view(xpath).compare(0, "srcql:"sv.size(), "srcql:") != 0 || !compileSrcQL(language))
+        return nullptr;
+
+    std::shared_lock lock(srcql_compiled_mutex);
+    const auto search = srcql_terms.find(language);
 
-    // free locally compiled xpath
-    if(is_srcql_query) {
-        xmlXPathFreeCompExpr(localCompiledXPath);
+    return search != srcql_terms.end() && search->second ? &*search->second : nullptr;
+}
+
+/**
+ * rejects
+ * @param srcml the srcML of the unit
+ * @param language the language of the unit
+ *
+ * @returns true if the srcML is missing an element name or text every match of the srcQL query contains
+ */
+bool xpathTransformation::rejects(std::string_view srcml, int language) const {
+
+    if (srcml.empty() || !element.empty() || !attr_name.empty())
+        return false;
+
+    if (compiled_xpath || std::string_view(xpath).compare(0, "srcql:"sv.size(), "srcql:") != 0 || !compileSrcQL(language))
+        return false;
+
+    std::shared_lock lock(srcql_compiled_mutex);
+    const auto search = srcql_required.find(language);
+
+    return search != srcql_required.end() && !srcql_features_found(search->second, srcml);
+}
+#pragma GCC diagnostic push
+
+/**
+ * apply
+ *
+ * Apply XPath expression, writing results.
+ *
+ * @returns true on success false on failure.
+ */
+TransformationResult xpathTransformation::apply(xmlDocPtr doc, int position) const {
+
+    // process srcQL query, where a query that does not compile was reported by compileSrcQL()
+    auto localCompiledXPath = compiled_xpath ? compiled_xpath : compileSrcQL(position);
+    if (!localCompiledXPath)
+        return TransformationResult();
+
+    thread_local std::vector<std::pair<std::string, std::optional<std::string>>> replaced;
+    xmlXPathContextPtr context = createContext(doc, replaced);
+    if (!context) {
+        fprintf(stderr, "%s: Error in executing xpath\n", "libsrcml");
+        return TransformationResult();
     }
 
+    // evaluate the xpath
+    std::unique_ptr<xmlXPathObject> result_nodes(xmlXPathCompiledEval(localCompiledXPath, context));
+
+    releaseContext(context, replaced);
+
     if (!result_nodes) {
         fprintf(stderr, "%s: Error in executing xpath\n", "libsrcml");
         return TransformationResult();
@@ -14,6 +14,16 @@
 
 #include <Transformation.hpp>
 #include <srcml_translator.hpp>
+#include <xpath_stream.hpp>
+#include <unit_index.hpp>
+#include <srcql.hpp>
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 /**
  * srcml_xpath
@@ -112,6 +122,38 @@ public :
      */
     virtual TransformationResult apply(xmlDocPtr doc, int position) const;
 
+    /**
+     * modifies_document
+     *
+     * Marking results with an element or attribute changes the doc.
+     */
+    virtual bool modifies_document() const { return !element.empty() || !attr_name.empty(); }
+
+    /**
+     * stream
+     *
+     * Simple paths, and counts of them, are evaluated without a DOM.
+     */
+    virtual const xpath_stream* stream() const { return streaming.get(); }
+
+    /**
+     * index_query
+     * @param language the language of the unit
+     *
+     * Terms of the XPath, or of the srcQL converted for the language.
+     * Marking results with an element or attribute has a result for every unit.
+     */
+    virtual const unit_index_query* index_query(int language) const;
+
+    /**
+     * rejects
+     * @param srcml the srcML of the unit
+     * @param language the language of the unit
+     *
+     * srcQL queries check for the element names and text every match contains.
+     */
+    virtual bool rejects(std::string_view srcml, int language) const;
+
     void addElementXPathResults(xmlDocPtr doc, xmlXPathObjectPtr result_nodes) const;
 
     // element namespace
@@ -131,10 +173,30 @@ public:
     std::string attr_value;
     xmlXPathCompExprPtr compiled_xpath = nullptr;
 
+    // streaming form of the xpath, if in the subset
+    std::unique_ptr<xpath_stream> streaming;
+
+    // terms a unit must contain for a result of the xpath, if known
+    std::optional<unit_index_query> index_terms;
+
     static const char* const simple_xpath_attribute_name;
 
 private:
-    xmlXPathContextPtr createContext(xmlDocPtr doc) const;
+    xmlXPathContextPtr createContext(xmlDocPtr doc, std::vector<std::pair<std::string, std::optional<std::string>>>& replaced) const;
+
+    void releaseContext(xmlXPathContextPtr context, const std::vector<std::pair<std::string, std::optional<std::string>>>& replaced) const;
+
+    xmlXPathCompExprPtr compileSrcQL(int language) const;
+
+    // compiled XPath of the srcQL query for each language, shared by all threads
+    mutable std::unordered_map<int, xmlXPathCompExprPtr> srcql_compiled;
+
+    // terms of the XPath of the srcQL query for each language
+    mutable std::unordered_map<int, std::optional<unit_index_query>> srcql_terms;
+
+    // features every match of the srcQL query contains for each language
+    mutable std::unordered_map<int, srcql_features> srcql_required;
+    mutable std::shared_mutex srcql_compiled_mutex;
 };
 
 #endif
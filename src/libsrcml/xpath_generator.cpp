@@ -150,6 +150,33 @@ std::string number_add_calls(std::string_view xpath_view) {
     return xpath;
 }
 
+// Replaces the variable names in the qli calls with small integer ids, so the
+// unification table is indexed by id instead of looked up by name
+std::string intern_variables(std::string_view xpath_view) {
+    std::string xpath(xpath_view);
+    std::map<std::string,size_t> ids;
+    for (const std::string call : { "qli:add-element(.,\"", "qli:match-element(.,\"", "qli:clear(\"", "qli:regex-match(\"" }) {
+        size_t start = 0;
+        while ((start = xpath.find(call,start)) != std::string::npos) {
+            size_t start_quote = start + call.size() - 1;
+            size_t end_quote = xpath.find("\"",start_quote+1);
+            if (end_quote == std::string::npos) {
+                break;
+            }
+            std::string identifier = xpath.substr(start_quote+1, end_quote-start_quote-1);
+            // regex-match variables start with the $
+            if (call == "qli:regex-match(\"" && !identifier.empty()) {
+                identifier.erase(0,1);
+            }
+            const size_t id = ids.emplace(identifier, ids.size()).first->second;
+            const std::string id_text = std::to_string(id);
+            xpath.replace(start_quote, end_quote-start_quote+1, id_text);
+            start = start_quote + id_text.size();
+        }
+    }
+    return xpath;
+}
+
 XPathNode* XPathGenerator::get_xpath_from_argument(std::string src_pattern) {
     // GET SRCML
     srcml_archive* holder = srcml_archive_create();
@@ -200,6 +227,8 @@ XPathNode* XPathGenerator::get_xpath_from_argument(std::string src_pattern) {
     xmlNode* srcml_root = change_from_macro ? top->children->children : top->children;
 
     get_variables(srcml_root);
+    pattern_features = srcql_features();
+    get_pattern_features(srcml_root);
     XPathNode* xpath_root = new XPathNode();
     convert_traverse(srcml_root, xpath_root);
     organize_add_calls(xpath_root);
@@ -227,6 +256,7 @@ std::string XPathGenerator::convert() {
     bool is_where_clause = false;
     bool is_with_op = false;
     int inner_id = 0;
+    srcql_features required;
     for (size_t i = 0; i < tokens.size(); ++i) {
         std::string token = tokens[i];
         // FIND - no-op, does nothing
@@ -257,6 +287,14 @@ std::string XPathGenerator::convert() {
 
             // If this is a where clause or with operator, do different steps
             if (!is_where_clause && !is_with_op) {
+                // Every match contains the first expression, and the ones it is combined with
+                bool is_required = operations.empty() ||
+                                   operations.back() == "CONTAINS" ||
+                                   operations.back() == "FOLLOWED" ||
+                                   operations.back() == "WITHIN" ||
+                                   operations.back() == "FROM" ||
+                                   operations.back() == "INTERSECT";
+
                 // Then determine expr type if not set
                 if (expr_type == "") {
                     // XPATH
@@ -275,6 +313,10 @@ std::string XPathGenerator::convert() {
                 // Next, convert into an XPathNode
                 if (expr_type == "PATTERN") {
                     node = get_xpath_from_argument(build_expr);
+                    if (is_required) {
+                        required.elements.insert(required.elements.end(),pattern_features.elements.begin(),pattern_features.elements.end());
+                        required.text.insert(required.text.end(),pattern_features.text.begin(),pattern_features.text.end());
+                    }
                 }
                 else if (expr_type == "XPATH") {
                     int count = 0;
@@ -287,6 +329,7 @@ std::string XPathGenerator::convert() {
                 }
                 else if (expr_type == "TAG") {
                     node = new XPathNode(build_expr);
+                    if (is_required) { required.elements.push_back(build_expr); }
                 }
             }
 
@@ -454,6 +497,15 @@ std::string XPathGenerator::convert() {
         }
     }
 
+    // A match of a UNION may not contain the required features of either side
+    if (std::find(operations.begin(),operations.end(),"UNION") == operations.end()) {
+        for (auto list : { &required.elements, &required.text }) {
+            std::sort(list->begin(),list->end());
+            list->erase(std::unique(list->begin(),list->end()),list->end());
+        }
+        features = required;
+    }
+
     // WHERE NOT and WHERE COUNT and WITH
     for (size_t i = 0; i < operations.size(); ++i) {
        /* WHERE NOT check
@@ -797,7 +849,7 @@ std::string XPathGenerator::convert() {
 
     if (!is_a_call && source_exprs[0]->get_type() != PARENTHESES) { source_exprs[0]->set_type(ANY); }
 
-    std::string xpath = source_exprs[0]->to_string();
+    std::string xpath = intern_variables(source_exprs[0]->to_string());
 
     // Free the xpath tree
     delete source_exprs[0];
@@ -811,9 +863,7 @@ void XPathGenerator::get_variables(xmlNode* top_xml_node) {
         if (node->type == XML_ELEMENT_NODE && is_variable_node(node)) {
             std::string text = get_text(node);
             std::string variable = extract_variable(text);
-            storage.add_to_variable_bucket(variable);
-            size_t order = storage.size_of_variable_bucket(variable)+1;
-            storage.add_to_number_bucket(variable,order);
+            size_t order = ++variable_orders[variable];
 
             std::string full_variable_text = "$" + variable + "_" + std::to_string(order);
 
@@ -827,6 +877,27 @@ void XPathGenerator::get_variables(xmlNode* top_xml_node) {
     }
 }
 
+// Collects the element names and text every match of the pattern contains.
+// Variables and comments are skipped, as are expr_stmt and expr elements that
+// also match decl_stmt and decl
+void XPathGenerator::get_pattern_features(xmlNode* top_xml_node) {
+    for (xmlNode* node = top_xml_node; node != NULL; node = node->next) {
+        if (node->type != XML_ELEMENT_NODE || get_full_name(node) == "src:comment" || is_variable_node(node)) { continue; }
+
+        std::string full_name = get_full_name(node);
+        bool has_alternative = !is_no_decl_language() &&
+            ((full_name == "src:expr_stmt" && get_full_name(node->children) == "src:expr" && xmlChildElementCount(node->children) == 1 && get_full_name(node->children->children) == "src:name") ||
+             (full_name == "src:expr" && xmlChildElementCount(node) == 1 && get_full_name(node->children) == "src:name"));
+        if (!has_alternative) { pattern_features.elements.push_back(full_name); }
+
+        if (has_only_text_child(node) && is_primitive_element(node)) {
+            pattern_features.text.push_back(get_text(node->children));
+        }
+
+        if (node->children && !has_only_text_child(node)) { get_pattern_features(node->children); }
+    }
+}
+
 // Moves all add-element calls to the end of it's sibling group
 void XPathGenerator::organize_add_calls(XPathNode* x_node) {
     if (x_node->is_variable_node()) {
@@ -991,7 +1062,8 @@ void XPathGenerator::convert_traverse(xmlNode* top_xml_node, XPathNode* x_node)
                 std::string prefix = text.substr(0,text.find("$"+full_variable_text));
                 std::string postfix = text.substr(prefix.length()+full_variable_text.length()+1,full_variable_text.length() - (prefix.length()+full_variable_text.length()));
                 // Add check function
-                if (storage.size_of_variable_bucket(variable) > 0 || prefix != "" || postfix != "") {
+                const auto orders = variable_orders.find(variable);
+                if ((orders != variable_orders.end() && orders->second > 0) || prefix != "" || postfix != "") {
                     std::string node_text = "qli:add-element(.,\""+variable+"\",X";
                     if (postfix != "" || prefix != "") {
                         node_text += ","+add_quotes(prefix);
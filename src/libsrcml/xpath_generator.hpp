@@ -1,24 +1,29 @@
+#include <map>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <libxml/tree.h>
 #include <libxml/parser.h>
 
-#include "unification_table.hpp"
 #include "xpath_node.hpp"
+#include "srcql.hpp"
 
 #ifndef SRCQL_XPATH_GENERATOR_HPP
 #define SRCQL_XPATH_GENERATOR_HPP
 
 class XPathGenerator {
 public:
-    XPathGenerator(std::string_view query, std::string_view lang) : src_query(query), language(lang) { storage = UnificationTable(); };
+    XPathGenerator(std::string_view query, std::string_view lang) : src_query(query), language(lang) {};
     std::string convert();
 
+    // features every match of the converted query contains
+    const srcql_features& get_features() const { return features; }
 
 private:
     XPathNode* get_xpath_from_argument(std::string query);
     void get_variables(xmlNode* top_xml_node);
+    void get_pattern_features(xmlNode* top_xml_node);
     void convert_traverse(xmlNode*, XPathNode*);
     void organize_add_calls(XPathNode*);
     void add_bucket_clears(XPathNode*, size_t);
@@ -43,7 +48,13 @@ private:
     // XPathNode* xpath_root;
     std::string src_query;
     std::string language;
-    UnificationTable storage;
+
+    // number of orders of each variable
+    std::map<std::string, size_t, std::less<>> variable_orders;
+
+    // features of the last pattern, and of the whole query
+    srcql_features pattern_features;
+    srcql_features features;
 };
 
 
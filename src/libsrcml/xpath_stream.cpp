@@ -0,0 +1,582 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file xpath_stream.cpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ */
+
+#include <xpath_stream.hpp>
+#include <srcmlns.hpp>
+
+#include <libxml/parser.h>
+#include <libxml/parserInternals.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    bool is_name_start(char c) {
+
+        return std::isalpha((unsigned char) c) || c == '_';
+    }
+
+    bool is_name_char(char c) {
+
+        return std::isalnum((unsigned char) c) || c == '_' || c == '-' || c == '.';
+    }
+
+    void skip_space(std::string_view s, std::size_t& pos) {
+
+        while (pos < s.size() && std::isspace((unsigned char) s[pos]))
+            ++pos;
+    }
+
+    // NCName at the position, or empty
+    std::string_view parse_name(std::string_view s, std::size_t& pos) {
+
+        if (pos >= s.size() || !is_name_start(s[pos]))
+            return {};
+
+        std::size_t start = pos;
+        while (pos < s.size() && is_name_char(s[pos]))
+            ++pos;
+
+        return s.substr(start, pos - start);
+    }
+
+    // unwrap an expression of the form name(inner)
+    bool unwrap(std::string_view& s, std::string_view function) {
+
+        if (s.size() < function.size() + 2 || s.compare(0, function.size(), function) != 0)
+            return false;
+
+        std::size_t pos = function.size();
+        skip_space(s, pos);
+        if (pos >= s.size() || s[pos] != '(' || s.back() != ')')
+            return false;
+
+        s = s.substr(pos + 1, s.size() - pos - 2);
+        while (!s.empty() && std::isspace((unsigned char) s.front()))
+            s.remove_prefix(1);
+        while (!s.empty() && std::isspace((unsigned char) s.back()))
+            s.remove_suffix(1);
+
+        return true;
+    }
+
+    void append_escaped_text(std::string& out, const char* text, std::size_t size) {
+
+        for (std::size_t i = 0; i < size; ++i) {
+            switch (text[i]) {
+            case '&':  out.append("&amp;"); break;
+            case '<':  out.append("&lt;"); break;
+            case '>':  out.append("&gt;"); break;
+            case '\r': out.append("&#13;"); break;
+            default:   out += text[i];
+            }
+        }
+    }
+
+    // attribute value, where SAX2 without entity substitution leaves & as &#38;
+    std::string attribute_value(const xmlChar** attribute) {
+
+        std::string value((const char*) attribute[3], (std::size_t) (attribute[4] - attribute[3]));
+        for (auto pos = value.find("&#38;"); pos != std::string::npos; pos = value.find("&#38;", pos + 1))
+            value.replace(pos, 5, "&");
+
+        return value;
+    }
+
+    // non-ASCII characters are character references, as libxml2 writes attributes of a document without an encoding
+    void append_escaped_attribute(std::string& out, const char* value, std::size_t size) {
+
+        for (std::size_t i = 0; i < size; ++i) {
+            if ((unsigned char) value[i] >= 0x80) {
+                int len = (int) std::min<std::size_t>(size - i, 4);
+                const int c = xmlGetUTF8Char((const xmlChar*) value + i, &len);
+
+                char ref[16];
+                if (c < 0) {
+                    std::snprintf(ref, sizeof(ref), "&#%d;", (unsigned char) value[i]);
+                } else {
+                    std::snprintf(ref, sizeof(ref), "&#x%X;", (unsigned int) c);
+                    i += (std::size_t) len - 1;
+                }
+                out.append(ref);
+                continue;
+            }
+
+            switch (value[i]) {
+            case '&':  out.append("&amp;"); break;
+            case '<':  out.append("&lt;"); break;
+            case '>':  out.append("&gt;"); break;
+            case '"':  out.append("&quot;"); break;
+            case '\n': out.append("&#10;"); break;
+            case '\r': out.append("&#13;"); break;
+            case '\t': out.append("&#9;"); break;
+            default:   out += value[i];
+            }
+        }
+    }
+
+    void append_qname(std::string& out, const xmlChar* prefix, const xmlChar* localname) {
+
+        if (prefix) {
+            out.append((const char*) prefix);
+            out += ':';
+        }
+        out.append((const char*) localname);
+    }
+
+    /** state of an evaluation */
+    struct evaluation {
+
+        /** serialization of a result element */
+        struct capture {
+            std::string text;
+            std::size_t depth = 0;
+            std::size_t index = 0;
+            bool open = false;
+            bool uses_cpp = false;
+            bool uses_omp = false;
+        };
+
+        xmlParserCtxtPtr context = nullptr;
+        xpath_stream::result_type type = xpath_stream::NODES;
+        const std::vector<xpath_stream::step>* steps = nullptr;
+        xpath_stream::result* out = nullptr;
+
+        // namespace URIs of the step and predicate prefixes
+        std::vector<std::string> step_uris;
+        std::vector<std::vector<std::string>> predicate_uris;
+
+        // steps to match on the children of each open element
+        std::vector<std::vector<std::size_t>> active;
+
+        std::vector<capture> captures;
+
+        bool fallback = false;
+        bool stopped = false;
+
+        void stop(bool need_dom) {
+
+            fallback = fallback || need_dom;
+            stopped = true;
+            xmlStopParser(context);
+        }
+
+        // resolve the prefixes with the standard namespaces and those declared on the root
+        bool resolve(int nb_namespaces, const xmlChar** namespaces) {
+
+            auto lookup = [&](const std::string& prefix, std::string& uri) {
+
+                for (int i = 0; i < nb_namespaces; ++i) {
+                    if (namespaces[i * 2] && prefix == (const char*) namespaces[i * 2]) {
+                        uri = (const char*) namespaces[i * 2 + 1];
+                        return true;
+                    }
+                }
+
+                for (const auto& ns : default_namespaces) {
+                    if (prefix == (ns.uri == SRCML_SRC_NS_URI ? "src"sv : std::string_view(ns.prefix))) {
+                        uri = ns.uri;
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+
+            for (const auto& step : *steps) {
+
+                std::string uri;
+                if (!step.prefix.empty() && !lookup(step.prefix, uri))
+                    return false;
+                step_uris.push_back(uri);
+
+                std::vector<std::string> uris;
+                for (const auto& predicate : step.predicates) {
+                    std::string attr_uri;
+                    if (!predicate.prefix.empty() && !lookup(predicate.prefix, attr_uri))
+                        return false;
+                    uris.push_back(attr_uri);
+                }
+                predicate_uris.push_back(std::move(uris));
+            }
+
+            return true;
+        }
+
+        bool matches(std::size_t pos, const xmlChar* localname, const xmlChar* URI, int nb_attributes, const xmlChar** attributes) const {
+
+            const auto& step = (*steps)[pos];
+
+            if (step.name != "*" && step.name != (const char*) localname)
+                return false;
+
+            if (!step.prefix.empty() && (!URI || step_uris[pos] != (const char*) URI))
+                return false;
+
+            for (std::size_t i = 0; i < step.predicates.size(); ++i) {
+
+                const auto& predicate = step.predicates[i];
+                const auto& uri = predicate_uris[pos][i];
+
+                bool found = false;
+                for (int j = 0; j < nb_attributes && !found; ++j) {
+
+                    const xmlChar** attribute = attributes + j * 5;
+                    if (predicate.name != (const char*) attribute[0])
+                        continue;
+
+                    if (uri.empty() ? attribute[2] != nullptr : (!attribute[2] || uri != (const char*) attribute[2]))
+                        continue;
+
+                    found = !predicate.value || attribute_value(attribute) == *predicate.value;
+                }
+
+                if (!found)
+                    return false;
+            }
+
+            return true;
+        }
+
+        // finish the start tag of the last element when it has content
+        void content() {
+
+            for (auto& capture : captures) {
+                if (capture.open) {
+                    capture.text += '>';
+                    capture.open = false;
+                }
+            }
+        }
+    };
+
+    void start_element(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI,
+                       int nb_namespaces, const xmlChar** namespaces,
+                       int nb_attributes, int /* nb_defaulted */, const xmlChar** attributes) {
+
+        auto state = (evaluation*) ((xmlParserCtxtPtr) ctx)->_private;
+        if (state->stopped)
+            return;
+
+        if (state->active.empty()) {
+            if (!state->resolve(nb_namespaces, namespaces)) {
+                state->stop(true);
+                return;
+            }
+
+            // the document node, with the first step to match
+            state->active.push_back({ 0 });
+        }
+
+        const std::size_t depth = state->active.size() - 1;
+        const auto& steps = *state->steps;
+
+        // steps to match on the children of this element
+        bool matched = false;
+        std::vector<std::size_t> next;
+        for (auto pos : state->active.back()) {
+
+            if (state->matches(pos, localname, URI, nb_attributes, attributes)) {
+                if (pos + 1 == steps.size())
+                    matched = true;
+                else if (std::find(next.begin(), next.end(), pos + 1) == next.end())
+                    next.push_back(pos + 1);
+            }
+
+            if (steps[pos].descendant && std::find(next.begin(), next.end(), pos) == next.end())
+                next.push_back(pos);
+        }
+        state->active.push_back(std::move(next));
+
+        if (matched) {
+
+            // a whole unit is a unit-wrapped result
+            if (depth == 0) {
+                state->stop(true);
+                return;
+            }
+
+            ++state->out->count;
+            if (state->type == xpath_stream::BOOLEAN) {
+                state->stop(false);
+                return;
+            }
+
+            if (state->type == xpath_stream::NODES) {
+                evaluation::capture capture;
+                capture.depth = depth;
+                capture.index = state->out->nodes.size();
+                state->out->nodes.emplace_back();
+                state->out->uses_cpp.push_back(false);
+                state->out->uses_omp.push_back(false);
+                state->content();
+                state->captures.push_back(std::move(capture));
+            }
+        }
+
+        if (state->captures.empty())
+            return;
+
+        // namespace declarations inside of results are left to the DOM
+        if (nb_namespaces) {
+            state->stop(true);
+            return;
+        }
+
+        state->content();
+
+        const bool cpp = prefix && URI && SRCML_CPP_NS_URI == (const char*) URI;
+        const bool omp = prefix && URI && SRCML_OPENMP_NS_URI == (const char*) URI;
+        for (auto& capture : state->captures) {
+
+            capture.text += '<';
+            append_qname(capture.text, prefix, localname);
+            for (int i = 0; i < nb_attributes; ++i) {
+                const xmlChar** attribute = attributes + i * 5;
+                capture.text += ' ';
+                append_qname(capture.text, attribute[1], attribute[0]);
+                capture.text += "=\"";
+                const auto value = attribute_value(attribute);
+                append_escaped_attribute(capture.text, value.data(), value.size());
+                capture.text += '"';
+            }
+            capture.open = true;
+
+            capture.uses_cpp = capture.uses_cpp || cpp;
+            capture.uses_omp = capture.uses_omp || omp;
+        }
+    }
+
+    void end_element(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* /* URI */) {
+
+        auto state = (evaluation*) ((xmlParserCtxtPtr) ctx)->_private;
+        if (state->stopped)
+            return;
+
+        state->active.pop_back();
+        if (state->captures.empty())
+            return;
+
+        for (auto& capture : state->captures) {
+            if (capture.open) {
+                capture.text += "/>";
+                capture.open = false;
+            } else {
+                capture.text += "</";
+                append_qname(capture.text, prefix, localname);
+                capture.text += '>';
+            }
+        }
+
+        // end of a result
+        auto& last = state->captures.back();
+        if (last.depth == state->active.size() - 1) {
+            state->out->nodes[last.index] = std::move(last.text);
+            state->out->uses_cpp[last.index] = last.uses_cpp;
+            state->out->uses_omp[last.index] = last.uses_omp;
+            state->captures.pop_back();
+        }
+    }
+
+    void characters(void* ctx, const xmlChar* ch, int len) {
+
+        auto state = (evaluation*) ((xmlParserCtxtPtr) ctx)->_private;
+        if (state->stopped || state->captures.empty())
+            return;
+
+        state->content();
+        for (auto& capture : state->captures)
+            append_escaped_text(capture.text, (const char*) ch, (std::size_t) len);
+    }
+
+    void comment(void* ctx, const xmlChar* value) {
+
+        auto state = (evaluation*) ((xmlParserCtxtPtr) ctx)->_private;
+        if (state->stopped || state->captures.empty())
+            return;
+
+        state->content();
+        for (auto& capture : state->captures) {
+            capture.text += "<!--";
+            capture.text.append((const char*) value);
+            capture.text += "-->";
+        }
+    }
+
+    // content serialized differently by the DOM
+    void unsupported(void* ctx, const xmlChar*, const xmlChar*) {
+
+        auto state = (evaluation*) ((xmlParserCtxtPtr) ctx)->_private;
+        if (!state->stopped && !state->captures.empty())
+            state->stop(true);
+    }
+
+    void unsupported_cdata(void* ctx, const xmlChar*, int) {
+
+        unsupported(ctx, nullptr, nullptr);
+    }
+}
+
+/**
+ * compile
+ * @param xpath an XPath expression
+ *
+ * @returns the streaming form of the XPath expression, or null if it is not in the subset
+ */
+std::unique_ptr<xpath_stream> xpath_stream::compile(std::string_view xpath) {
+
+    while (!xpath.empty() && std::isspace((unsigned char) xpath.front()))
+        xpath.remove_prefix(1);
+    while (!xpath.empty() && std::isspace((unsigned char) xpath.back()))
+        xpath.remove_suffix(1);
+
+    std::unique_ptr<xpath_stream> stream(new xpath_stream);
+    if (unwrap(xpath, "count"sv))
+        stream->expression_type = COUNT;
+    else if (unwrap(xpath, "boolean"sv))
+        stream->expression_type = BOOLEAN;
+
+    std::size_t pos = 0;
+    while (pos < xpath.size()) {
+
+        step current;
+        if (xpath[pos] != '/')
+            return nullptr;
+        ++pos;
+        if (pos < xpath.size() && xpath[pos] == '/') {
+            current.descendant = true;
+            ++pos;
+        }
+
+        // name test of *, prefix:*, or prefix:name
+        if (pos < xpath.size() && xpath[pos] == '*') {
+            current.name = "*";
+            ++pos;
+        } else {
+            current.prefix = parse_name(xpath, pos);
+            if (current.prefix.empty() || pos >= xpath.size() || xpath[pos] != ':')
+                return nullptr;
+            ++pos;
+            if (pos < xpath.size() && xpath[pos] == '*') {
+                current.name = "*";
+                ++pos;
+            } else {
+                current.name = parse_name(xpath, pos);
+                if (current.name.empty())
+                    return nullptr;
+            }
+        }
+
+        // attribute predicates
+        while (pos < xpath.size() && xpath[pos] == '[') {
+            ++pos;
+            skip_space(xpath, pos);
+            if (pos >= xpath.size() || xpath[pos] != '@')
+                return nullptr;
+            ++pos;
+
+            predicate attribute;
+            attribute.name = parse_name(xpath, pos);
+            if (attribute.name.empty())
+                return nullptr;
+            if (pos < xpath.size() && xpath[pos] == ':') {
+                ++pos;
+                attribute.prefix = std::move(attribute.name);
+                attribute.name = parse_name(xpath, pos);
+                if (attribute.name.empty())
+                    return nullptr;
+            }
+            skip_space(xpath, pos);
+
+            if (pos < xpath.size() && xpath[pos] == '=') {
+                ++pos;
+                skip_space(xpath, pos);
+                if (pos >= xpath.size() || (xpath[pos] != '\'' && xpath[pos] != '"'))
+                    return nullptr;
+                const char quote = xpath[pos];
+                auto end = xpath.find(quote, pos + 1);
+                if (end == std::string_view::npos)
+                    return nullptr;
+                attribute.value = std::string(xpath.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+                skip_space(xpath, pos);
+            }
+
+            if (pos >= xpath.size() || xpath[pos] != ']')
+                return nullptr;
+            ++pos;
+
+            current.predicates.push_back(std::move(attribute));
+        }
+
+        stream->steps.push_back(std::move(current));
+    }
+
+    if (stream->steps.empty())
+        return nullptr;
+
+    return stream;
+}
+
+/**
+ * evaluate
+ * @param srcml the srcML of a unit
+ * @param out the result of the evaluation
+ *
+ * Evaluate the expression while parsing the srcML of the unit with SAX. Result
+ * elements are serialized as they are parsed. When the result needs the DOM, e.g.,
+ * the whole unit is a result, the evaluation stops.
+ *
+ * @returns true on success, and false if the expression must be evaluated on the DOM
+ */
+bool xpath_stream::evaluate(std::string_view srcml, result& out) const {
+
+    evaluation state;
+    state.type = expression_type;
+    state.steps = &steps;
+    state.out = &out;
+
+    xmlSAXHandler sax;
+    memset(&sax, 0, sizeof(sax));
+    sax.initialized           = XML_SAX2_MAGIC;
+    sax.startElementNs        = start_element;
+    sax.endElementNs          = end_element;
+    sax.characters            = characters;
+    sax.ignorableWhitespace   = characters;
+    sax.comment               = comment;
+    sax.cdataBlock            = unsupported_cdata;
+    sax.processingInstruction = unsupported;
+
+    xmlParserCtxtPtr context = xmlCreateMemoryParserCtxt(srcml.data(), (int) srcml.size());
+    if (context == nullptr)
+        return false;
+    xmlCtxtUseOptions(context, XML_PARSE_HUGE);
+    state.context = context;
+
+    auto save_private = context->_private;
+    context->_private = &state;
+    auto save_sax = context->sax;
+    context->sax = &sax;
+
+    int status = xmlParseDocument(context);
+    const bool well_formed = context->wellFormed != 0;
+
+    context->_private = save_private;
+    context->sax = save_sax;
+    xmlFreeParserCtxt(context);
+
+    if (state.fallback)
+        return false;
+
+    if (!state.stopped && (status != 0 || !well_formed))
+        return false;
+
+    return true;
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file xpath_stream.hpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * Streaming evaluation of a subset of XPath on the SAX events of a unit.
+ */
+
+#ifndef INCLUDED_XPATH_STREAM_HPP
+#define INCLUDED_XPATH_STREAM_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * xpath_stream
+ *
+ * Evaluates forward-axis XPath expressions without building a DOM:
+ *
+ *     path | count(path) | boolean(path)
+ *
+ * where a path is a sequence of child (/) and descendant (//) steps from
+ * the root. Each step is a name test, prefix:name, prefix:*, or *, with
+ * optional attribute predicates, [@name] or [@name='value']. Prefixes are
+ * the standard srcML prefixes, or ones declared on the unit.
+ *
+ * Anything else is not compiled, and is left to libxml2 XPath.
+ */
+class xpath_stream {
+
+public :
+
+    enum result_type { NODES, COUNT, BOOLEAN };
+
+    /** result of an evaluation */
+    struct result {
+        std::size_t count = 0;
+        std::vector<std::string> nodes;
+        std::vector<bool> uses_cpp;
+        std::vector<bool> uses_omp;
+    };
+
+    // the streaming form of the XPath, or null if not in the subset
+    static std::unique_ptr<xpath_stream> compile(std::string_view xpath);
+
+    result_type type() const { return expression_type; }
+
+    // evaluate on the srcML of a unit, false when the DOM is needed
+    bool evaluate(std::string_view srcml, result& out) const;
+
+    /** attribute predicate */
+    struct predicate {
+        std::string prefix;
+        std::string name;
+        std::optional<std::string> value;
+    };
+
+    /** location step */
+    struct step {
+        bool descendant = false;
+        std::string prefix;
+        std::string name;
+        std::vector<predicate> predicates;
+    };
+
+private :
+
+    result_type expression_type = NODES;
+    std::vector<step> steps;
+};
+
+#endif
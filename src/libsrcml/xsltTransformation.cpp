@@ -20,40 +20,83 @@
 #include <libxslt/transform.h>
 #include <libexslt/exslt.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #ifdef _MSC_VER
 #include <io.h>
 #endif
 
+namespace {
+
+    // exslt functions are registered once for all transformations
+    std::mutex xslt_globals_mutex;
+    bool exslt_registered = false;
+
+    // compiled stylesheets by the URL and contents of the XSLT
+    std::unordered_map<std::string, std::weak_ptr<xsltStylesheet>> stylesheets;
+}
+
 /**
  * xsltTransformation
  * @param options list of srcML options
  * @param stylesheet an XSLT stylesheet
  * @param params XSLT parameters
  *
- * Constructor.  Dynamically loads XSLT functions.
+ * Constructor.  Uses the compiled stylesheet of an identical XSLT,
+ * so each stylesheet is compiled once.
  */
 xsltTransformation::xsltTransformation(/* OPTION_TYPE& options, */ xmlDocPtr xslt, const std::vector<std::string>& params)
         : params(params) {
 
+    std::lock_guard<std::mutex> lock(xslt_globals_mutex);
+
     // allow for all exslt functions
-    exsltRegisterAll();
+    if (!exslt_registered) {
+        exsltRegisterAll();
+        exslt_registered = true;
+    }
+
+    // relative imports and includes depend on the URL
+    xmlChar* contents = nullptr;
+    int size = 0;
+    xmlDocDumpMemory(xslt, &contents, &size);
+    std::string key(xslt->URL ? (const char*) xslt->URL : "");
+    key += '\n';
+    if (contents)
+        key.append((const char*) contents, (std::size_t) size);
+    xmlFree(contents);
+
+    stylesheet = stylesheets[key].lock();
+    if (stylesheet) {
+        xmlFreeDoc(xslt);
+        return;
+    }
 
-    // parse the stylesheet
-    stylesheet = xsltParseStylesheetDoc(xslt);
+    // parse the stylesheet, which then owns the XSLT document
+    stylesheet.reset(xsltParseStylesheetDoc(xslt), [](xsltStylesheetPtr stylesheet) { xsltFreeStylesheet(stylesheet); });
     if (!stylesheet)
         throw;
+
+    // entries of freed stylesheets are removed as new ones are added
+    for (auto it = stylesheets.begin(); it != stylesheets.end(); ) {
+        it = it->second.expired() ? stylesheets.erase(it) : std::next(it);
+    }
+    stylesheets[key] = stylesheet;
 }
 
 /**
- * ~xsltTransformation
+ * cleanup
  *
- * Destructor.  Closes dynamically loaded library.
+ * Free the XSLT globals, including the exslt registration.
  */
-xsltTransformation::~xsltTransformation() {
+void xsltTransformation::cleanup() {
 
-    xsltFreeStylesheet(stylesheet);
+    std::lock_guard<std::mutex> lock(xslt_globals_mutex);
 
     xsltCleanupGlobals();
+    exslt_registered = false;
 }
 
 /**
@@ -65,15 +108,16 @@ xsltTransformation::~xsltTransformation() {
  */
 TransformationResult xsltTransformation::apply(xmlDocPtr doc, int /* position */) const {
 
-    // convert to c-array of c-strings, null terminated
-    std::vector<const char*> cparams(xsl_parameters.size() + 1);
-    for (size_t i = 0; i < xsl_parameters.size(); ++i) {
-        cparams[i] = xsl_parameters[i].data();
+    // convert to c-array of c-strings, null terminated, reusing the array of the thread
+    thread_local std::vector<const char*> cparams;
+    cparams.clear();
+    for (const auto& param : xsl_parameters) {
+        cparams.push_back(param.data());
     }
-    cparams.back() = 0;
+    cparams.push_back(0);
 
     // apply the style sheet to the document, which is the individual unit
-    std::shared_ptr<xmlDoc> res(xsltApplyStylesheetUser(stylesheet, doc, cparams.data(), 0, 0, 0), [](xmlDoc* doc) { xmlFreeDoc(doc); });
+    std::shared_ptr<xmlDoc> res(xsltApplyStylesheetUser(stylesheet.get(), doc, cparams.data(), 0, 0, 0), [](xmlDoc* doc) { xmlFreeDoc(doc); });
     if (!res) {
         fprintf(stderr, "libsrcml:  Error in applying stylesheet\n");
 
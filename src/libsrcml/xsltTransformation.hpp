@@ -23,6 +23,8 @@
 #include <libxslt/xsltutils.h>
 #include <libexslt/exslt.h>
 
+#include <memory>
+
 #ifdef _MSC_VER
 #include <io.h>
 #endif
@@ -47,11 +49,11 @@ public :
     xsltTransformation(/*OPTION_TYPE& options,*/ xmlDocPtr xslt, const std::vector<std::string>& params);
 
     /**
-     * ~xsltTransformation
+     * cleanup
      *
-     * Destructor.  Closes dynamically loaded library.
+     * Free the XSLT globals, including the exslt registration.
      */
-    virtual ~xsltTransformation();
+    static void cleanup();
 
     /**
      * apply
@@ -63,7 +65,8 @@ public :
     virtual TransformationResult apply(xmlDocPtr doc, int position) const;
 
 private :
-    xsltStylesheetPtr stylesheet = nullptr;
+    // compiled stylesheet, shared by all transformations with the same XSLT
+    std::shared_ptr<xsltStylesheet> stylesheet;
     const std::vector<std::string> params;
 };
 
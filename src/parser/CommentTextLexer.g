@@ -33,6 +33,9 @@ header {
    #include <antlr/TokenStreamSelector.hpp>
    #include <srcml_options.hpp>
    #include <Language.hpp>
+   #include <srcMLToken.hpp>
+   #include <Position.hpp>
+   #include <UTF8CharBuffer.hpp>
 }
 
 options {
@@ -116,16 +119,83 @@ public:
 
 CommentTextLexer(const antlr::LexerSharedInputState& state, int language)
     : antlr::CharScanner(state, true), Language(language), mode(0), onpreprocline(false), noescape(false), delimiter1("")
-{}
+{
+    setTokenObjectFactory(srcMLToken::factory);
+}
 
 private:
     antlr::TokenStreamSelector* selector;
+    Position* position = nullptr;
 
 public:
     void setSelector(antlr::TokenStreamSelector* selector_) {
         selector=selector_;
     }
 
+    // enable position tracking, shared with the KeywordLexer
+    void setPosition(Position* position_) {
+        position = position_;
+    }
+
+    virtual void consume() {
+
+        if (position && inputState->guessing == 0)
+            position->advance(LA(1), tabsize);
+
+        antlr::CharScanner::consume();
+    }
+
+    /*
+      Consume the run of characters that follows with no special meaning in comments,
+      strings, and characters. These go directly into the token text, and the run ends
+      before any character that is processed one at a time in COMMENT_TEXT.
+
+      Returns the last character of the run, or 0 if there is no run.
+    */
+    int consumeTextRun() {
+
+        static const struct RunStops {
+            bool stop[256] = {};
+            RunStops() {
+                // control characters (including tab and newline), quotes, raw string
+                // delimiter end, comment end, and escapes
+                for (int c = '\000'; c <= '\037'; ++c)
+                    stop[c] = true;
+                stop[(unsigned char) '"'] = true;
+                stop[(unsigned char) '\''] = true;
+                stop[(unsigned char) ')'] = true;
+                stop[(unsigned char) '/'] = true;
+                stop[(unsigned char) '\\'] = true;
+            }
+        } runStops;
+
+        auto run = static_cast<UTF8CharBuffer&>(inputState->getInput()).consumeRun(runStops.stop);
+        if (run.empty())
+            return 0;
+
+        // same as consume() for each character of the run
+        text.append(run.data(), run.size());
+        inputState->column += (int) run.size();
+        if (position)
+            position->append(run, tabsize);
+
+        return static_cast<unsigned char>(run.back());
+    }
+
+    virtual antlr::RefToken makeToken(int t) {
+
+        auto token = antlr::CharScanner::makeToken(t);
+
+        // stamp the end position of the token
+        if (position) {
+            srcMLToken* stoken = static_cast<srcMLToken*>(&(*token));
+            stoken->endline = position->line;
+            stoken->endcolumn = position->column;
+        }
+
+        return token;
+    }
+
     // reinitialize comment lexer
     void init(int m, bool onpreproclinestate, bool nescape = false, std::string dstring = "", bool /* is_line */ = false, long /* lnumber */ = -1, OPTION_TYPE op = 0) {
 
@@ -198,7 +268,7 @@ COMMENT_TEXT {
 
         // end at EOL when for line comment, or the end of a string or char on a preprocessor line
         // Special case in C++ and C with end of comment
-        if ((mode == LINE_COMMENT_END || mode == LINE_DOXYGEN_COMMENT_END) && (inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C)) && prevLA == '\\') {
+        if ((mode == LINE_COMMENT_END || mode == LINE_DOXYGEN_COMMENT_END) && inLanguage(LANGUAGE_C | LANGUAGE_CXX) && prevLA == '\\') {
 
             ;
 
@@ -432,6 +502,13 @@ COMMENT_TEXT {
         // not the first character anymore
         first = false;
 
+        // take any following run of characters that need no processing in one step
+        if (_ttype == COMMENT_TEXT && inputState->guessing == 0) {
+            int last = consumeTextRun();
+            if (last)
+                prevprevLA = last;
+        }
+
         /* 
             About to read a newline, or the EOF.  Line comments may need
             to end before the newline is consumed. Strings and characters on a preprocessor line also need to end, even if unterminated
@@ -439,7 +516,7 @@ COMMENT_TEXT {
             Line comments are not ended if there is a line continuation character for C and C++. They do end the line comment for
             C# and Java
         */
-        if (_ttype == COMMENT_TEXT && (inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C)) && prevprevLA == '\\' && LA(1) == '\n') {
+        if (_ttype == COMMENT_TEXT && inLanguage(LANGUAGE_C | LANGUAGE_CXX) && prevprevLA == '\\' && LA(1) == '\n') {
 
             // line continuation for C++ and C of line comments
             ;
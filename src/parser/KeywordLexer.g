@@ -35,6 +35,7 @@ header {
     #include <antlr/TokenStreamSelector.hpp>
     #include <CommentTextLexer.hpp>
     #include <srcMLToken.hpp>
+    #include <Position.hpp>
     #undef CONST
     #undef VOID
     #undef DELETE
@@ -48,24 +49,111 @@ header {
 
 header "post_include_cpp" {
 
+namespace {
+
+    // characters that end a run consumed directly from the input
+    struct RunStops {
+        bool stop[256];
+        RunStops(bool (*inrun)(int c)) {
+            for (int c = 0; c < 256; ++c)
+                stop[c] = !inrun(c);
+        }
+    };
+
+    // rest of a NAME
+    const RunStops nameRun([](int c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80 || c == '$';
+    });
+
+    // rest of WS when tabs are expanded
+    const RunStops spaceRun([](int c) {
+        return c == ' ';
+    });
+
+    // rest of WS
+    const RunStops blankRun([](int c) {
+        return c == ' ' || c == '\t';
+    });
+}
+
 void KeywordLexer::changetotextlexer(int typeend, std::string delim) {
 
     selector->push("text"); 
     ((CommentTextLexer* ) (selector->getStream("text")))->init(typeend, onpreprocline, atstring, delim, isline, line_number, options);
 }
 
+void KeywordLexer::consume() {
+
+    // track the position as each character is consumed, so tokens are stamped without rescanning their text
+    if (position && inputState->guessing == 0)
+        position->advance(LA(1), tabsize);
+
+    antlr::CharScanner::consume();
+}
+
+antlr::RefToken KeywordLexer::makeToken(int t) {
+
+    auto token = antlr::CharScanner::makeToken(t);
+
+    // stamp the end position of the token
+    if (position) {
+        srcMLToken* stoken = static_cast<srcMLToken*>(&(*token));
+        stoken->endline = position->line;
+        stoken->endcolumn = position->column;
+    }
+
+    return token;
+}
+
+int KeywordLexer::consumeRun(const bool (&stop)[256]) {
+
+    if (inputState->guessing != 0)
+        return 0;
+
+    auto run = static_cast<UTF8CharBuffer&>(inputState->getInput()).consumeRun(stop);
+    if (run.empty())
+        return 0;
+
+    // same as consume() for each character of the run
+    text.append(run.data(), run.size());
+    if (run.find('\t') == std::string_view::npos) {
+        inputState->column += (int) run.size();
+    } else {
+        for (const auto c : run) {
+            if (c == '\t')
+                tab();
+            else
+                ++inputState->column;
+        }
+    }
+    if (position)
+        position->append(run, tabsize);
+
+    return static_cast<unsigned char>(run.back());
+}
+
+void KeywordLexer::consumeNameRun() {
+
+    consumeRun(nameRun.stop);
+}
+
+void KeywordLexer::consumeWhitespaceRun() {
+
+    consumeRun(isoption(options, SRCML_PARSER_OPTION_EXPAND_TABS) ? spaceRun.stop : blankRun.stop);
+}
+
 int KeywordLexer::testLiteralsTable(int ttype) const {
 
-    const auto p = srcMLLiterals.find(text);
-    if (p != srcMLLiterals.end())
+    const auto p = srcMLLiterals->find(text);
+    if (p != srcMLLiterals->end())
         return p->second;
     return ttype;
 }
 
 int KeywordLexer::testLiteralsTable(const std::string& txt, int ttype) const {
 
-    const auto p = srcMLLiterals.find(txt);
-    if (p != srcMLLiterals.end())
+    const auto p = srcMLLiterals->find(txt);
+    if (p != srcMLLiterals->end())
         return p->second;
     return ttype;
 }
@@ -375,6 +463,15 @@ void changetotextlexer(int typeend, std::string delimiter = "");
 virtual int testLiteralsTable(int ttype) const;
 virtual int testLiteralsTable(const std::string& txt, int ttype) const;
 
+// position tracking, shared with the CommentTextLexer
+virtual void consume();
+virtual antlr::RefToken makeToken(int t);
+
+// runs of identifier and whitespace characters consumed in one step
+int consumeRun(const bool (&stop)[256]);
+void consumeNameRun();
+void consumeWhitespaceRun();
+
 KeywordLexer(UTF8CharBuffer* pinput, int language, OPTION_TYPE & options,
              std::vector<std::string> user_macro_list)
     : antlr::CharScanner(pinput,true), Language(language), options(options), onpreprocline(false), startline(true),
@@ -805,20 +902,35 @@ KeywordLexer(UTF8CharBuffer* pinput, int language, OPTION_TYPE & options,
         { "yield"        , PY_YIELD          , LANGUAGE_PYTHON },
    };
 
+    // literals depend only on the language, so they are filled once per thread
+    // and shared by all units in that language
+    thread_local std::unordered_map<int, std::unordered_map<std::string_view, int>> languageLiterals;
+    auto& currentLiterals = languageLiterals[getLanguage()];
+
     // fill up the literals for the language that we are parsing
-    for (unsigned int i = 0; i < (sizeof(keyword_map) / sizeof(keyword_map[0])); ++i)
-        if (inLanguage(keyword_map[i].language)) {
-            srcMLLiterals[keyword_map[i].text] = keyword_map[i].token;
-        }
+    if (currentLiterals.empty()) {
+        for (unsigned int i = 0; i < (sizeof(keyword_map) / sizeof(keyword_map[0])); ++i)
+            if (inLanguage(keyword_map[i].language)) {
+                currentLiterals[keyword_map[i].text] = keyword_map[i].token;
+            }
+    }
+
+    srcMLLiterals = &currentLiterals;
 }
 
 private:
     antlr::TokenStreamSelector* selector;
-    std::unordered_map<std::string_view, int> srcMLLiterals;
+    const std::unordered_map<std::string_view, int>* srcMLLiterals = nullptr;
+    Position* position = nullptr;
 public:
     void setSelector(antlr::TokenStreamSelector* selector_) {
         selector = selector_;
     }
+
+    // enable position tracking
+    void setPosition(Position* position_) {
+        position = position_;
+    }
 }
 
 protected
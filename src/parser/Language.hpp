@@ -122,7 +122,8 @@ public:
     /**
      * inLanguage
      *
-     * Predicate method to test if in a current language
+     * Predicate method to test if in a current language. A set of
+     * languages, e.g., LANGUAGE_C | LANGUAGE_CXX, is a single test.
      *
      * @returns if in the current language.
      */
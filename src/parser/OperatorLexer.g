@@ -145,7 +145,7 @@ OPERATORS options { testLiterals = true; } {
     '>' (('>' '=') => '>' '=')? ('=')? |
 
     // <, << (C/C++), <=, <<< (CUDA), <> (Python)
-    '<' ('=' | '<' ({ inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C) }? '<' | '=')? | { inLanguage(LANGUAGE_PYTHON) }? '>' )? |
+    '<' ('=' | '<' ({ inLanguage(LANGUAGE_C | LANGUAGE_CXX) }? '<' | '=')? | { inLanguage(LANGUAGE_PYTHON) }? '>' )? |
 
     // match these as individual operators only
     ',' | ';' | '('..')' | '[' | ']' | '{' | '}' | 
@@ -165,18 +165,18 @@ OPERATORS options { testLiterals = true; } {
         { inLanguage(LANGUAGE_OBJECTIVE_C) }?
           '{'
         |
-        { inLanguage(LANGUAGE_CSHARP) || inLanguage(LANGUAGE_OBJECTIVE_C) }?
+        { inLanguage(LANGUAGE_CSHARP | LANGUAGE_OBJECTIVE_C) }?
             NAME { $setType(NAME); }
         |
         { inLanguage(LANGUAGE_OBJECTIVE_C) }?
             CONSTANTS { $setType(CONSTANTS); }
         |
-        { inLanguage(LANGUAGE_CSHARP) || inLanguage(LANGUAGE_OBJECTIVE_C) }? {
+        { inLanguage(LANGUAGE_CSHARP | LANGUAGE_OBJECTIVE_C) }? {
             $setType(CHAR_START);
         }
         CHAR_START |
 
-        { inLanguage(LANGUAGE_CSHARP) || inLanguage(LANGUAGE_OBJECTIVE_C) }? {
+        { inLanguage(LANGUAGE_CSHARP | LANGUAGE_OBJECTIVE_C) }? {
             atstring = true; 
             $setType(STRING_START);
         }
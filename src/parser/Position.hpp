@@ -31,25 +31,29 @@ struct Position {
         column = token->getColumn() - 1;
     }
 
-    void append(std::string_view text, size_t tabsize) {
+    void advance(int c, size_t tabsize) {
 
         // Update line and column
         // * When you reach a newline, reset column
         // * Tabs are expanded
         // * Unicode continuation characters are ignored
         // * Combining marks start for the range 0x0300 through 0x036F
-        for (auto p = text.begin(); p != text.end(); ++p) {
-            if (*p == '\n') {
-                ++line;
-                column = 0;
-            } else if (*p == '\t') {
-                column = ((column / (int)tabsize) + 1) * (int)tabsize;
-            } else if ((*p & 0xC0) != 0x80 && (unsigned char)*p != 0xCC) {
-                ++column;
-            }
+        if (c == '\n') {
+            ++line;
+            column = 0;
+        } else if (c == '\t') {
+            column = ((column / (int)tabsize) + 1) * (int)tabsize;
+        } else if ((c & 0xC0) != 0x80 && (unsigned char)c != 0xCC) {
+            ++column;
         }
     }
 
+    void append(std::string_view text, size_t tabsize) {
+
+        for (auto c : text)
+            advance(c, tabsize);
+    }
+
     bool operator==(const Position& other) {
 
         return line == other.line && column == other.column;
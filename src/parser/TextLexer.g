@@ -146,6 +146,9 @@ CONSTANTS :
 NAME options { testLiterals = true; } :
     { startline = false; }
     ('a'..'z' | 'A'..'Z' | '_' | '\200'..'\377' | '$')
+
+    // take the rest of the name in one step, with the loop for any remainder
+    { consumeNameRun(); }
     ((options { greedy = true; } : '0'..'9' | 'a'..'z' | 'A'..'Z' | '_' | '\200'..'\377' | '$')*)
     (
         { text == "L"sv || text == "U"sv || text == "u"sv || text == "u8"sv }?
@@ -200,7 +203,7 @@ LINE_COMMENT_START options { testLiterals = true; } { int mode = 0; } : '/'
                 $setType(JAVADOC_COMMENT_START);
                 mode = JAVADOC_COMMENT_END;
             } ('/' { $setType(WHOLE_COMMENT); mode = 0; })? |
-            { inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C) || inLanguage(LANGUAGE_CSHARP) }? ('*' | '!')
+            { inLanguage(LANGUAGE_C | LANGUAGE_CXX | LANGUAGE_CSHARP) }? ('*' | '!')
             {
                 $setType(DOXYGEN_COMMENT_START);
                 mode = DOXYGEN_COMMENT_END;
@@ -225,8 +228,8 @@ LINE_COMMENT_START options { testLiterals = true; } { int mode = 0; } : '/'
 
 // whitespace (except for newline)
 WS { int lastColumn = 0; } : (
-    // single space
-    ' ' |
+    // single space, and the rest of the whitespace in one step
+    ' ' { consumeWhitespaceRun(); } |
 
     // horizontal tab
     { lastColumn = getColumn(); } '\t' {
@@ -241,6 +244,8 @@ WS { int lastColumn = 0; } : (
             static const std::string_view spaces = "        ";
             text.append(spaces.substr(0, getColumn() - lastColumn));
         }
+
+        consumeWhitespaceRun();
     }
 )+
 
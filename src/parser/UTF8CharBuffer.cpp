@@ -439,6 +439,43 @@ int UTF8CharBuffer::getChar() {
     return c;
 }
 
+/**
+ * consumeRun
+ * @param stop table of characters that end the run
+ *
+ * Consume the run of already converted characters up to, but not including,
+ * the first stop character. Carriage returns and newlines always end the run,
+ * so line handling stays with getChar(). The run does not cross into the next
+ * read of the input, and is only taken when the lookahead buffer is empty,
+ * i.e., directly after a consume() and before the next LA().
+ *
+ * @returns the consumed characters, valid until the next read of the input.
+ */
+std::string_view UTF8CharBuffer::consumeRun(const bool (&stop)[256]) {
+
+    // characters already in the lookahead must be processed first
+    syncConsume();
+    if (nMarkers > 0 || queue.entries() > 0 || pos >= insize)
+        return std::string_view();
+
+    const char* buffer = (trivial ? raw : cooked).data();
+    const char* start = buffer + pos;
+    const char* end = buffer + insize;
+
+    const char* p = start;
+    while (p != end && !stop[static_cast<unsigned char>(*p)] && *p != '\r' && *p != '\n')
+        ++p;
+
+    if (p == start)
+        return std::string_view();
+
+    pos += p - start;
+    lastcr = false;
+    lastchar = static_cast<unsigned char>(p[-1]);
+
+    return std::string_view(start, p - start);
+}
+
 /**
  * getEncoding
  *
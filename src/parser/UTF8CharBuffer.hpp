@@ -87,6 +87,9 @@ public:
     // Get the next character from the stream
     int getChar();
 
+    // Consume the run of buffered characters up to the first stop character
+    std::string_view consumeRun(const bool (&stop)[256]);
+
     // Get the used encoding
     std::string_view getEncoding() const;
 
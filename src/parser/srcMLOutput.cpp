@@ -108,6 +108,9 @@ void srcMLOutput::initNamespaces(const Namespaces& otherns) {
 srcMLOutput::~srcMLOutput() {
 
     close();
+
+    if (document)
+        xmlFreeDoc(document);
 }
 
 /**
@@ -132,6 +135,85 @@ void srcMLOutput::close() {
     }
 }
 
+/**
+ * startDocument
+ *
+ * Build a document of the unit contents from the consumed tokens, in
+ * addition to the srcML output. The document root is a placeholder
+ * element that declares all the namespaces. The caller replaces it
+ * with the final unit element.
+ */
+void srcMLOutput::startDocument() {
+
+    if (document)
+        xmlFreeDoc(document);
+
+    document = xmlNewDoc(BAD_CAST XML_VERSION.data());
+
+    // element names are looked up in the shared dictionary first
+    document->dict = xmlDictCreateSub(namesDictionary());
+
+    documentParent = xmlNewDocNode(document, nullptr, BAD_CAST "unit", nullptr);
+    xmlDocSetRootElement(document, documentParent);
+
+    for (int i = SRC; i <= OMP; ++i) {
+        const auto& ns = namespaces[i];
+        documentNamespaces[i] = xmlNewNs(documentParent, BAD_CAST ns.uri.data(), !ns.prefix.empty() ? BAD_CAST ns.prefix.data() : nullptr);
+        if (!documentNamespaces[i])
+            documentNamespaces[i] = xmlSearchNsByHref(document, documentParent, BAD_CAST ns.uri.data());
+    }
+}
+
+/**
+ * releaseDocument
+ *
+ * Release the document built from the consumed tokens.
+ *
+ * @returns the document, or null if no document was started.
+ */
+xmlDoc* srcMLOutput::releaseDocument() {
+
+    xmlDoc* doc = document;
+    document = nullptr;
+    documentParent = nullptr;
+
+    return doc;
+}
+
+/**
+ * namesDictionary
+ *
+ * Dictionary of all element and attribute names. Each document has its own
+ * dictionary with this one as a subdictionary. It is never changed after
+ * creation so can be shared between threads.
+ *
+ * @returns the dictionary of names.
+ */
+xmlDict* srcMLOutput::namesDictionary() {
+
+    // not freed, as it may be in use by documents until exit
+    static xmlDict* const names = []() {
+
+        xmlDict* dict = xmlDictCreate();
+        for (const auto& entry : process) {
+            const Element& element = entry.second;
+            if (element.name)
+                xmlDictLookup(dict, BAD_CAST element.name, -1);
+            if (element.attr_name)
+                xmlDictLookup(dict, BAD_CAST element.attr_name, -1);
+            if (element.attr2_name)
+                xmlDictLookup(dict, BAD_CAST element.attr2_name, -1);
+        }
+
+        for (const auto name : { "unit", "start", "end" })
+            xmlDictLookup(dict, BAD_CAST name, -1);
+
+        return dict;
+    }();
+
+    return names;
+}
+
 void srcMLOutput::outputUnitSeparator() {
 
     processText("\n\n", 2);
@@ -201,8 +283,11 @@ void srcMLOutput::consume(const char* language, const char* revision, const char
             auto search = process.find(token->getType());
             if (!(search != process.end() && search->second.name)) {
 
-                // update the text position
-                currentPosition.append(token->getText(), tabsize);
+                // update the text position from the end position stamped by the lexer
+                // tokens generated after lexing have no stamp and no width
+                srcMLToken* stoken = static_cast<srcMLToken*>(&(*token));
+                if (stoken->endline)
+                    currentPosition = Position(stoken->endline, stoken->endcolumn);
 
                 // save the text
                 tokenQueue.push_back(token);
@@ -592,6 +677,98 @@ void srcMLOutput::addPosition(const antlr::RefToken& token) {
     xmlOutputBufferWrite(output_buffer, 1, "\"");
 }
 
+/**
+ * documentText
+ * @param str text to add
+ *
+ * Add text to the current element of the document, merging with any previous text.
+ */
+void srcMLOutput::documentText(std::string_view str) {
+
+    if (str.empty())
+        return;
+
+    xmlNode* last = documentParent->last;
+    if (last && last->type == XML_TEXT_NODE) {
+        xmlNodeAddContentLen(last, BAD_CAST str.data(), (int) str.size());
+        return;
+    }
+
+    xmlAddChild(documentParent, xmlNewDocTextLen(document, BAD_CAST str.data(), (int) str.size()));
+}
+
+/**
+ * documentPosition
+ * @param node document element
+ * @param token token with the position
+ *
+ * Add the position attributes to a document element, the same as addPosition().
+ */
+void srcMLOutput::documentPosition(xmlNode* node, const antlr::RefToken& token) {
+
+    srcMLToken* stoken = static_cast<srcMLToken*>(&(*token));
+
+    // how we detect empty elements: the position is wrong
+    if (stoken->endline < stoken->getLine() || (stoken->endline == stoken->getLine() && stoken->endcolumn < stoken->getColumn()))
+            return;
+
+    std::string value = positoa(token->getLine());
+    value += ':';
+    value += positoa(token->getColumn());
+    xmlNewNsProp(node, documentNamespaces[POS], BAD_CAST "start", BAD_CAST value.data());
+
+    value.clear();
+    if (token->getLine() > stoken->endline) {
+        value += "INVALID_POS(";
+        value += positoa(stoken->endline);
+        value += ')';
+    } else {
+        value += positoa(stoken->endline);
+    }
+    value += ':';
+    value += positoa(stoken->endcolumn);
+    xmlNewNsProp(node, documentNamespaces[POS], BAD_CAST "end", BAD_CAST value.data());
+}
+
+/**
+ * documentToken
+ * @param token token to add
+ * @param eparts element parts of the token
+ * @param attr_value value of the first attribute
+ *
+ * Add the element of a token to the document. Called after processToken(),
+ * which updates positions.
+ */
+void srcMLOutput::documentToken(const antlr::RefToken& token, const Element& eparts, const char* attr_value) {
+
+    // no name, no token
+    if (eparts.name[0] == 0)
+        return;
+
+    if (isstart(token) || isempty(token)) {
+
+        xmlNode* node = xmlNewDocNode(document, documentNamespaces[eparts.prefix], BAD_CAST eparts.name, nullptr);
+        xmlAddChild(documentParent, node);
+
+        if (eparts.attr_name)
+            xmlNewProp(node, BAD_CAST eparts.attr_name, BAD_CAST attr_value);
+
+        if (eparts.attr2_name)
+            xmlNewProp(node, BAD_CAST eparts.attr2_name, BAD_CAST eparts.attr2_value);
+
+        if (isoption(options, SRCML_PARSER_OPTION_POSITION) && (!isempty(token) || token->getType() == srcMLParserTokenTypes::STYPEPREV))
+            documentPosition(node, token);
+
+        documentParent = node;
+    }
+
+    // never leave the placeholder root
+    if ((!isstart(token) || isempty(token)) && documentParent->parent && documentParent->parent->type == XML_ELEMENT_NODE) {
+
+        documentParent = documentParent->parent;
+    }
+}
+
 void srcMLOutput::processToken(const antlr::RefToken& token, const char* name, const char* prefix, const char* attr_name1, const char* attr_value1,
                                 const char* attr_name2, const char* attr_value2) {
 
@@ -662,19 +839,28 @@ inline void srcMLOutput::outputToken(const antlr::RefToken& token) {
     if (search != process.end() && search->second.name) {
         const Element& eparts = search->second;
 
+        // if attribute name and no value, then take text from token
+        const std::string text = eparts.attr_name && !eparts.attr_value ? token->getText() : std::string();
+        const char* attr_value = eparts.attr_value ? eparts.attr_value : text.data();
+
         // process the token using the fields in the element
         processToken(token, eparts.name,
                     // use getPrefix() to record that this prefix was used
                     namespaces[eparts.prefix].getPrefix().data(),
                     eparts.attr_name,
-                    // if attribute name and no value, then take text from token
-                    eparts.attr_name && eparts.attr_value ? eparts.attr_value : token->getText().data(),
+                    attr_value,
                     eparts.attr2_name,
                     eparts.attr2_value);
 
+        if (document)
+            documentToken(token, eparts, attr_value);
+
         return;
     }
 
     // remainder are treated as text tokens
     processText(token);
+
+    if (document)
+        documentText(token->getText());
 }
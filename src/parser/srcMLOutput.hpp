@@ -112,6 +112,12 @@ public:
     // close the output
     void close();
 
+    // also build a document of the unit contents while consuming
+    void startDocument();
+
+    // document built while consuming, caller frees with xmlFreeDoc()
+    xmlDoc* releaseDocument();
+
     // destructor
     ~srcMLOutput();
 
@@ -136,6 +142,18 @@ private:
     // adds the position attributes to a token
     void addPosition(const antlr::RefToken& token);
 
+    // add text to the document
+    void documentText(std::string_view str);
+
+    // add an element for the token to the document
+    void documentToken(const antlr::RefToken& token, const Element& eparts, const char* attr_value);
+
+    // adds the position attributes to a document element
+    void documentPosition(xmlNode* node, const antlr::RefToken& token);
+
+    // dictionary of element and attribute names shared by all documents
+    static xmlDict* namesDictionary();
+
     // token stream input
     TokenStream* input = nullptr;
 
@@ -203,6 +221,15 @@ private:
     Position lastTypeEndPosition;
     Position lastTypeStartPosition;
 
+    // document built from the tokens, with a placeholder root element for the unit
+    xmlDoc* document = nullptr;
+
+    // current parent element in the document
+    xmlNode* documentParent = nullptr;
+
+    // document namespaces for each of the prefix positions
+    xmlNs* documentNamespaces[OMP + 1] = { nullptr };
+
     // token handler
     void processToken(const antlr::RefToken& token, const char* name, const char* prefix,
                       const char* attr_name1, const char* attr_value1,
@@ -4292,7 +4292,7 @@ class_preprocessing[int token] { ENTRY_DEBUG } :
             startElement(token);
 
             // classes end at the end of the block
-            if (intypedef || inLanguage(LANGUAGE_JAVA_FAMILY) || inLanguage(LANGUAGE_CSHARP)) {
+            if (intypedef || inLanguage(LANGUAGE_JAVA_FAMILY | LANGUAGE_CSHARP)) {
                 setMode(MODE_END_AT_BLOCK);
             }
         }
@@ -4954,7 +4954,7 @@ lcurly[bool content = true] { ENTRY_DEBUG } :
 lcurly_base[bool content = true] { ENTRY_DEBUG } :
         {
             // need to pass on class mode to detect constructors for java
-            bool inclassmode = (inLanguage(LANGUAGE_JAVA_FAMILY) || inLanguage(LANGUAGE_CSHARP)) && inMode(MODE_CLASS);
+            bool inclassmode = inLanguage(LANGUAGE_JAVA_FAMILY | LANGUAGE_CSHARP) && inMode(MODE_CLASS);
 
             bool in_function_body = inTransparentMode(MODE_FUNCTION_TAIL);
 
@@ -5337,7 +5337,7 @@ statement_part[] {
 
         // K&R function parameters
         {
-            (inLanguage(LANGUAGE_C) || inLanguage(LANGUAGE_CXX))
+            inLanguage(LANGUAGE_C | LANGUAGE_CXX)
             && inMode(MODE_FUNCTION_TAIL)
             && pattern_check(stmt_type, secondtoken, type_count, after_token)
             && stmt_type == VARIABLE
@@ -7080,7 +7080,7 @@ class_lead_type_identifier[] { SingleElement element(this); ENTRY_DEBUG } :
 */
 macro_type_detector[] { ENTRY_DEBUG } :
 
-        { inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C) }?
+        { inLanguage(LANGUAGE_C | LANGUAGE_CXX) }?
         NAME paren_pair NAME (TERMINATE | LCURLY | EQUALS)
 ;
 
@@ -7568,7 +7568,7 @@ variable_identifier_array_grammar_sub_contents { bool found_expr = false; bool i
         { !inLanguage(LANGUAGE_CSHARP) && !inLanguage(LANGUAGE_OBJECTIVE_C) }?
         complete_expression |
 
-        { inLanguage(LANGUAGE_CSHARP) || inLanguage(LANGUAGE_OBJECTIVE_C) }?
+        { inLanguage(LANGUAGE_CSHARP | LANGUAGE_OBJECTIVE_C) }?
         (options { greedy = true; } :
             { LA(1) != RBRACKET }?
             (
@@ -8578,7 +8578,7 @@ compound_name_inner[bool index] {
             compound_name_c[iscompound] |
 
             // Python uses the same C++ logic for names
-            { inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_PYTHON) }?
+            { inLanguage(LANGUAGE_CXX | LANGUAGE_PYTHON) }?
             compound_name_cpp[iscompound] |
 
             macro_type_name_call
@@ -13786,7 +13786,7 @@ template_argument[bool in_function_type = false] { CompleteElement element(this)
             else
                startElement(STEMPLATE_PARAMETER);
 
-            if (inLanguage(LANGUAGE_CXX) || inLanguage(LANGUAGE_C))
+            if (inLanguage(LANGUAGE_C | LANGUAGE_CXX))
                startElement(SEXPRESSION);
         }
 
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file benchmark_lexer_runs.cpp
+ *
+ * @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+ *
+ * Microbenchmark for identifier and whitespace runs in the lexer.
+ *
+ * Parses generated source made mostly of long identifiers and indentation
+ * for each language and reports the throughput. Compare the output of
+ * builds before and after a lexer change to see the gain per language.
+ *
+ * Usage: benchmark_lexer_runs [lines] [repetitions]
+ */
+
+#include <srcml.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+    // generate source with long identifiers and whitespace runs in the style of the language
+    std::string generate(const char* language, int lines) {
+
+        const bool python = std::string(language) == "Python";
+
+        std::string src;
+        if (!python)
+            src += "void benchmark_function_name() {\n";
+        else
+            src += "def benchmark_function_name():\n";
+
+        for (int i = 0; i < lines; ++i) {
+            src += "        ";
+            src += "resulting_value_" + std::to_string(i);
+            src += "    =    ";
+            src += "some_long_identifier_name    +    another_long_identifier_name";
+            src += python ? "\n" : ";\n";
+        }
+
+        if (!python)
+            src += "}\n";
+
+        return src;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    const int lines = argc > 1 ? atoi(argv[1]) : 10000;
+    const int repetitions = argc > 2 ? atoi(argv[2]) : 10;
+
+    const char* languages[] = { "C", "C++", "C#", "Java", "Objective-C", "Python" };
+
+    // units are parsed but never written
+    char* buffer = nullptr;
+    size_t size = 0;
+    srcml_archive* archive = srcml_archive_create();
+    srcml_archive_write_open_memory(archive, &buffer, &size);
+
+    for (const auto language : languages) {
+
+        const std::string src = generate(language, lines);
+
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, language);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; ++i)
+            srcml_unit_parse_memory(unit, src.data(), src.size());
+        const auto finish = std::chrono::steady_clock::now();
+
+        srcml_unit_free(unit);
+
+        const double seconds = std::chrono::duration<double>(finish - start).count();
+        const double megabytes = (double) src.size() * repetitions / (1024 * 1024);
+        printf("%-12s %10.3f s %10.2f MB/s\n", language, seconds, megabytes / seconds);
+    }
+
+    srcml_archive_close(archive);
+    srcml_archive_free(archive);
+    srcml_memory_free(buffer);
+
+    return 0;
+}
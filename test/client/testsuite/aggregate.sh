@@ -0,0 +1,61 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-3.0-only
+#
+# @file aggregate.sh
+#
+# @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test reducing scalar query results of all units
+defineXML srcml_nested <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION">
+
+	<unit revision="REVISION" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="REVISION" language="C++" filename="b.cpp"><expr_stmt><expr><name>b</name> <operator>+</operator> <name>c</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="REVISION" language="C++" filename="c.cpp"><expr_stmt><expr><name>d</name></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+STDOUT
+
+createfile sub/a.xml "$srcml_nested"
+
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=sum
+check "4\n"
+
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=count
+check "3\n"
+
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=min
+check "1\n"
+
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=max
+check "2\n"
+
+srcml sub/a.xml --xpath "boolean(//src:operator)" --aggregate=any
+check "true\n"
+
+srcml sub/a.xml --xpath "boolean(//src:operator)" --aggregate=all
+check "false\n"
+
+define histogram <<- 'STDOUT'
+	1	2
+	2	1
+STDOUT
+
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=histogram
+check "$histogram"
+
+srcml --xpath "count(//src:name)" --aggregate=histogram <<< "$srcml_nested"
+check "$histogram"
+
+# invalid mode
+srcml sub/a.xml --xpath "count(//src:name)" --aggregate=avg
+check_exit 1
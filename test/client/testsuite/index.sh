@@ -0,0 +1,123 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-3.0-only
+#
+# @file index.sh
+#
+# @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test index option
+
+define sfile1 <<- 'STDOUT'
+	a;
+STDOUT
+
+define sfile2 <<- 'STDOUT'
+	b;
+STDOUT
+
+define nestedfile <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="1.0.0">
+
+	<unit revision="1.0.0" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="1.0.0" language="C++" filename="b.cpp" hash="0123"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+STDOUT
+
+define index <<- 'STDOUT'
+	srcml-index 3
+	size\t372
+	header\t118
+	footer\t</unit>
+	unit\t120\t114\tC++\t\ta.cpp
+	unit\t236\t126\tC++\t0123\tb.cpp
+STDOUT
+
+createfile sub/a.cpp.xml "$nestedfile"
+
+srcml --index sub/a.cpp.xml
+check
+
+# the modification time and file serial number of the archive vary
+grep -v -e "^mtime" -e "^inode" sub/a.cpp.xml.idx
+check "$index"
+
+grep -c -e "^mtime" -e "^inode" sub/a.cpp.xml.idx
+check "2\n"
+
+# units are read with the index
+srcml sub/a.cpp.xml --unit "2"
+check "$sfile2"
+
+srcml sub/a.cpp.xml --unit "1"
+check "$sfile1"
+
+srcml --index sub/a.cpp.xml --show-unit-count
+check "2\n"
+
+grep -v -e "^mtime" -e "^inode" sub/a.cpp.xml.idx
+check "$index"
+
+# an index for an archive edited to the same size is not used
+editedfile="${nestedfile//<name>a</<name>aa<}"
+createfile sub/a.cpp.xml "${editedfile//hash=\"0123\"/hash=\"012\"}"
+
+srcml sub/a.cpp.xml --unit "1"
+check "aa;\n"
+
+srcml sub/a.cpp.xml --unit "2"
+check "$sfile2"
+
+# an archive edited to the same size with the same modification time is indexed again
+# when the unit is not at its indexed position
+createfile sub/a.cpp.xml "$nestedfile"
+
+srcml --index sub/a.cpp.xml
+check
+
+touch -r sub/a.cpp.xml sub/a.cpp.xml.time
+createfile sub/a.cpp.xml "${editedfile//hash=\"0123\"/hash=\"012\"}"
+touch -r sub/a.cpp.xml.time sub/a.cpp.xml
+
+srcml sub/a.cpp.xml --unit "1"
+check "aa;\n"
+
+srcml sub/a.cpp.xml --unit "2"
+check "$sfile2"
+
+# the requested unit is read without the preceding units, which cannot be parsed
+define brokenfile <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="1.0.0">
+
+	<unit revision="1.0.0" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</nam></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="1.0.0" language="C++" filename="b.cpp" hash="0123"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+STDOUT
+
+define parse_error <<- 'STDERR'
+	Error Parsing: Opening and ending tag mismatch: name line 4 and nam
+
+STDERR
+
+createfile sub/broken.cpp.xml "$brokenfile"
+
+srcml sub/broken.cpp.xml --unit "2"
+check "$sfile2" "$parse_error"
+
+srcml --index sub/broken.cpp.xml
+check "" "$parse_error"
+
+srcml sub/broken.cpp.xml --unit "2"
+check "$sfile2" "$parse_error"
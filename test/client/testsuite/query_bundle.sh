@@ -0,0 +1,42 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-3.0-only
+#
+# @file query_bundle.sh
+#
+# @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test applying each query independently to the same unit
+defineXML srcml_nested <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION">
+
+	<unit revision="REVISION" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="REVISION" language="C++" filename="b.cpp"><expr_stmt><expr><name>b</name> <operator>+</operator> <name>c</name></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+STDOUT
+
+define output <<- 'STDOUT'
+	1	1
+	2	a.cpp
+	1	2
+	2	b.cpp
+STDOUT
+
+createfile sub/a.xml "$srcml_nested"
+
+srcml sub/a.xml --query-bundle --xpath "count(//src:name)" --xpath "string(//src:unit/@filename)"
+check "$output"
+
+srcml --query-bundle --xpath "count(//src:name)" --xpath "string(//src:unit/@filename)" <<< "$srcml_nested"
+check "$output"
+
+# each query is output separately, so aggregation is rejected
+srcml sub/a.xml --query-bundle --xpath "count(//src:name)" --aggregate=sum
+check_exit 1
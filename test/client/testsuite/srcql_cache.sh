@@ -0,0 +1,45 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-3.0-only
+#
+# @file srcql_cache.sh
+#
+# @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test caching the conversions of srcql queries
+defineXML result <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" xmlns:pre="foo.com" revision="REVISION" language="C++" filename="sub/a.cpp"><expr_stmt><pre:element><expr><name>a</name></expr></pre:element>;</expr_stmt>
+	</unit>
+STDOUT
+
+createfile sub/a.cpp "a;
+"
+srcml sub/a.cpp --xmlns:pre=foo.com -o sub/a.xml
+
+# the first run converts the query, and adds it to the cache
+srcml sub/a.xml --srcql='FIND $N' --element="pre:element" --xmlns:pre=foo.com --srcql-cache=sub/srcql.cache
+check "$result"
+
+head -n 1 sub/srcql.cache
+check "srcql-cache 2\n"
+
+# the next run uses the cached conversion
+srcml sub/a.xml --srcql='FIND $N' --element="pre:element" --xmlns:pre=foo.com --srcql-cache=sub/srcql.cache
+check "$result"
+
+# a file that is not a cache is not used, or replaced
+srcml sub/a.xml --srcql='FIND $N' --element="pre:element" --xmlns:pre=foo.com --srcql-cache=sub/a.cpp
+check_exit 2 "srcml: 'sub/a.cpp' is not a srcQL cache\n"
+
+# a cache of other versions is replaced
+createfile sub/srcql.cache "srcql-cache 1\nversion\t0.0.0\t0.0.0\n"
+srcml sub/a.xml --srcql='FIND $N' --element="pre:element" --xmlns:pre=foo.com --srcql-cache=sub/srcql.cache
+check "$result"
+
+head -n 1 sub/srcql.cache
+check "srcql-cache 2\n"
+
+rm -f sub/srcql.cache
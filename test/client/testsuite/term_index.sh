@@ -0,0 +1,78 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-3.0-only
+#
+# @file term_index.sh
+#
+# @copyright Copyright (C) 2024 srcML, LLC. (www.srcML.org)
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test term-index option
+
+define nestedfile <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="1.0.0">
+
+	<unit revision="1.0.0" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="1.0.0" language="C++" filename="b.cpp"><expr_stmt><expr><name>b</name> <operator>+</operator> <literal type="number">1</literal></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+STDOUT
+
+define index <<- 'STDOUT'
+	srcml-term-index 3
+	size\t418
+	units\t2
+	term\tafilename=a.cpp\t0
+	term\tafilename=b.cpp\t1
+	term\talanguage=C++\t0 1
+	term\tarevision=1.0.0\t0 1
+	term\tatype=number\t1
+	term\te{http://www.srcML.org/srcML/src}expr\t0 1
+	term\te{http://www.srcML.org/srcML/src}expr_stmt\t0 1
+	term\te{http://www.srcML.org/srcML/src}literal\t1
+	term\te{http://www.srcML.org/srcML/src}name\t0 1
+	term\te{http://www.srcML.org/srcML/src}operator\t1
+	term\te{http://www.srcML.org/srcML/src}unit\t0 1
+	term\tna\t0
+	term\tnb\t1
+STDOUT
+
+createfile sub/a.cpp.xml "$nestedfile"
+
+srcml --term-index sub/a.cpp.xml
+check
+
+# the modification time and file serial number of the archive vary
+grep -v -e "^mtime" -e "^inode" sub/a.cpp.xml.tidx
+check "$index"
+
+grep -c -e "^mtime" -e "^inode" sub/a.cpp.xml.tidx
+check "2\n"
+
+# queries skip the units without the terms, with the same results
+srcml sub/a.cpp.xml --xpath "count(//src:expr[src:name='b'])"
+check "0\n1\n"
+
+srcml sub/a.cpp.xml --xpath "boolean(//src:literal[@type='number'])"
+check "false\ntrue\n"
+
+srcml sub/a.cpp.xml --xpath "count(//src:name[.='a'])" --aggregate=sum
+check "1\n"
+
+# the attributes of the units are terms
+srcml sub/a.cpp.xml --xpath "count(/src:unit[@filename='b.cpp']//src:name)"
+check "0\n1\n"
+
+srcml sub/a.cpp.xml --xpath "boolean(/src:unit[@language='C++'])"
+check "true\ntrue\n"
+
+# an edit of the same size makes the term index stale, so it is not used
+createfile sub/a.cpp.xml "${nestedfile//<name>a</<name>b<}"
+
+srcml sub/a.cpp.xml --xpath "count(//src:expr[src:name='b'])"
+check "1\n1\n"
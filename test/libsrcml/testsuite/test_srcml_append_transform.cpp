@@ -11,6 +11,7 @@
 #include <srcml.h>
 
 #include <string>
+#include <vector>
 #include <fstream>
 
 #if defined(__GNUC__) && !defined(__MINGW32__)
@@ -292,6 +293,175 @@ int main(int, char* argv[]) {
         dassert(srcml_append_transform_srcql_element(0, "$T $V;", "sup", "http://srcML.org/Supplement", "contain"), SRCML_STATUS_INVALID_ARGUMENT);
     }
 
+    /*
+      srcml_set_srcql_cache
+    */
+
+    {
+        dassert(srcml_set_srcql_cache(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    {
+        dassert(srcml_set_srcql_cache("copy.xsl"), SRCML_STATUS_INVALID_INPUT);
+    }
+
+    {
+        std::ofstream out("srcql.cache");
+        // a torn entry, without its end line, is not used
+        out << "srcql-cache 2\nversion\t1.0.0\t" << srcml_version_string() << "\n"
+            << "query\tC++:FIND x\t//src:operator\n"
+            << "query\tC++:FIND x\t//src:name\nelement\tsrc:name\nend\n";
+        out.close();
+
+        dassert(srcml_set_srcql_cache("srcql.cache"), SRCML_STATUS_OK);
+
+        const std::string srcml = R"(<unit xmlns="http://www.srcML.org/srcML/src" revision="1.0.0" language="C++"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>
+)";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml.c_str(), srcml.size());
+        dassert(srcml_append_transform_srcql(archive, "FIND x"), SRCML_STATUS_OK);
+
+        // the cached XPath is used instead of converting the query
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(archive, unit, &result);
+
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(result), 1);
+
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        unlink("srcql.cache");
+    }
+
+    {
+        std::ofstream out("srcql.cache");
+        // a different XPath for each language, and one that does not compile
+        out << "srcql-cache 2\nversion\t1.0.0\t" << srcml_version_string() << "\n"
+            << "query\tC++:FIND y\t//src:name\nend\n"
+            << "query\tJava:FIND y\t//src:operator\nend\n"
+            << "query\tC:FIND y\t//src:name[\nend\n";
+        out.close();
+
+        dassert(srcml_set_srcql_cache("srcql.cache"), SRCML_STATUS_OK);
+
+        const std::vector<std::string> units = {
+            R"(<unit revision="1.0.0" language="C++"><expr_stmt><expr><name>a</name> <operator>+</operator> <name>b</name></expr>;</expr_stmt></unit>)",
+            R"(<unit revision="1.0.0" language="Java"><expr_stmt><expr><name>a</name> <operator>+</operator> <name>b</name></expr>;</expr_stmt></unit>)",
+            R"(<unit revision="1.0.0" language="C++"><expr_stmt><expr><name>c</name></expr>;</expr_stmt></unit>)",
+            R"(<unit revision="1.0.0" language="Java"><expr_stmt><expr><name>c</name> <operator>-</operator> <name>d</name> <operator>*</operator> <name>e</name></expr>;</expr_stmt></unit>)",
+        };
+        const std::vector<int> sizes = { 2, 1, 1, 2 };
+
+        // results of a query compiled for only the one unit
+        std::vector<std::string> uncached;
+        for (const auto& unit_srcml : units) {
+
+            const std::string srcml = R"(<unit xmlns="http://www.srcML.org/srcML/src">)" + unit_srcml + "</unit>";
+
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_read_open_memory(archive, srcml.c_str(), srcml.size());
+            srcml_append_transform_srcql(archive, "FIND y");
+
+            srcml_unit* unit = srcml_archive_read_unit(archive);
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(archive, unit, &result);
+
+            std::string text;
+            for (int i = 0; i < srcml_transform_get_unit_size(result); ++i)
+                text += srcml_unit_get_srcml(srcml_transform_get_unit(result, i));
+            uncached.push_back(text);
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+        }
+
+        // each language, more than once, with the same transformation
+        std::string srcml = R"(<unit xmlns="http://www.srcML.org/srcML/src">)";
+        for (const auto& unit_srcml : units)
+            srcml += unit_srcml;
+        srcml += "</unit>";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml.c_str(), srcml.size());
+        dassert(srcml_append_transform_srcql(archive, "FIND y"), SRCML_STATUS_OK);
+
+        for (std::size_t pos = 0; pos < units.size(); ++pos) {
+
+            srcml_unit* unit = srcml_archive_read_unit(archive);
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(archive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), sizes[pos]);
+
+            std::string text;
+            for (int i = 0; i < srcml_transform_get_unit_size(result); ++i)
+                text += srcml_unit_get_srcml(srcml_transform_get_unit(result, i));
+            dassert(text, uncached[pos]);
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        unlink("srcql.cache");
+    }
+
+    {
+        // a query that does not compile is only reported once per language
+        const std::string srcml = R"(<unit xmlns="http://www.srcML.org/srcML/src"><unit revision="1.0.0" language="C"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit><unit revision="1.0.0" language="C"><expr_stmt><expr><name>b</name></expr>;</expr_stmt></unit></unit>)";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml.c_str(), srcml.size());
+        dassert(srcml_append_transform_srcql(archive, "FIND y"), SRCML_STATUS_OK);
+
+        fflush(stderr);
+        int saved_stderr = dup(2);
+        int errors = open("srcql.errors", O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        dup2(errors, 2);
+        close(errors);
+
+        for (int pos = 0; pos < 2; ++pos) {
+
+            srcml_unit* unit = srcml_archive_read_unit(archive);
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(archive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), 0);
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+        }
+
+        fflush(stderr);
+        dup2(saved_stderr, 2);
+        close(saved_stderr);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        std::ifstream in("srcql.errors");
+        std::string output((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+
+        int compile_errors = 0;
+        for (auto pos = output.find("Unable to compile srcQL query for C\n"); pos != std::string::npos; pos = output.find("Unable to compile srcQL query for C\n", pos + 1))
+            ++compile_errors;
+        dassert(compile_errors, 1);
+        dassert(output.find("Error in executing xpath"), std::string::npos);
+
+        unlink("srcql.errors");
+    }
+
     /*
       srcml_append_transform_xslt_filename
     */
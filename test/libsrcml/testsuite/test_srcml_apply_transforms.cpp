@@ -10,6 +10,10 @@
 #include <srcml.h>
 
 #include <fstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #if defined(__GNUC__) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -280,6 +284,45 @@ int main(int, char* argv[]) {
         free(s);
     }
 
+    // xpath results written directly are the same as the result units
+    for (const auto& xpath : { "//src:expr_stmt//*", "//src:expr_stmt//*[true()]" }) {
+
+        std::vector<std::string> outputs;
+        for (bool direct : { true, false }) {
+            char* s;
+            size_t size;
+            srcml_archive* iarchive = srcml_archive_create();
+            srcml_archive_read_open_memory(iarchive, srcml_a.c_str(), srcml_a.size());
+            srcml_append_transform_xpath(iarchive, xpath);
+            srcml_archive* oarchive = srcml_archive_clone(iarchive);
+            srcml_archive_disable_solitary_unit(oarchive);
+            srcml_archive_write_open_memory(oarchive, &s, &size);
+
+            srcml_unit* unit = srcml_archive_read_unit(iarchive);
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(iarchive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), 2);
+            if (direct) {
+                dassert(srcml_archive_write_transform_result(oarchive, result), SRCML_STATUS_OK);
+            } else {
+                for (int i = 0; i < srcml_transform_get_unit_size(result); ++i)
+                    srcml_archive_write_unit(oarchive, srcml_transform_get_unit(result, i));
+            }
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+
+            srcml_archive_close(oarchive);
+            srcml_archive_free(oarchive);
+            srcml_archive_close(iarchive);
+            srcml_archive_free(iarchive);
+            outputs.push_back(std::string(s, size));
+            free(s);
+        }
+
+        dassert(outputs[0], outputs[1]);
+    }
+
     //  xpath number result
     {
         srcml_archive* iarchive = srcml_archive_create();
@@ -672,6 +715,39 @@ int main(int, char* argv[]) {
         free(s);
     }
 
+    // xslt results written directly are the same as the result units
+    for (bool direct : { true, false }) {
+        char* s;
+        size_t size;
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive, srcml_full.c_str(), srcml_full.size());
+        srcml_append_transform_xslt_filename(iarchive, "setlanguage.xsl");
+        srcml_append_transform_param(iarchive, "language", "\"Java\"");
+        srcml_archive* oarchive = srcml_archive_clone(iarchive);
+        srcml_archive_write_open_memory(oarchive, &s, &size);
+
+        srcml_unit* unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(iarchive, unit, &result);
+
+        dassert(srcml_transform_get_unit_size(result), 1);
+        if (direct) {
+            dassert(srcml_archive_write_transform_result(oarchive, result), SRCML_STATUS_OK);
+        } else {
+            srcml_archive_write_unit(oarchive, srcml_transform_get_unit(result, 0));
+        }
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        srcml_archive_close(oarchive);
+        srcml_archive_free(oarchive);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+
+        dassert(std::string(s, size), srcml_full_python);
+        free(s);
+    }
+
     //  xslt_memory
 
     {
@@ -1452,6 +1528,52 @@ int main(int, char* argv[]) {
         free(s);
     }
 
+    // invalid unit between valid units
+    {
+        const std::string srcml_units = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src" xmlns:cpp="http://www.srcML.org/srcML/cpp" revision="1.0.0">
+
+<unit revision="1.0.0" language="C" filename="a.c"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>
+
+<unit revision="1.0.0" language="C" filename="b.c"><cpp:include>#<cpp:directive>include</cpp:directive></cpp:include>
+</unit>
+
+<unit revision="1.0.0" language="C" filename="c.c"><expr_stmt><expr><name>c</name></expr>;</expr_stmt>
+</unit>
+
+</unit>
+)";
+
+        // no cpp elements as children of the unit
+        const std::string schema_nocpp = R"(<grammar xmlns="http://relaxng.org/ns/structure/1.0" ns="http://www.srcML.org/srcML/src">
+  <start><element name="unit"><zeroOrMore><choice><attribute><anyName/></attribute><text/>
+    <element><anyName><except><nsName ns="http://www.srcML.org/srcML/cpp"/></except></anyName><ref name="any"/></element>
+  </choice></zeroOrMore></element></start>
+  <define name="any"><zeroOrMore><choice><attribute><anyName/></attribute><text/><element><anyName/><ref name="any"/></element></choice></zeroOrMore></define>
+</grammar>
+)";
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive, srcml_units.c_str(), srcml_units.size());
+        srcml_append_transform_relaxng_memory(iarchive, schema_nocpp.c_str(), schema_nocpp.size());
+
+        const std::vector<int> sizes = { 1, 0, 1 };
+        for (int expected : sizes) {
+            srcml_unit* unit = srcml_archive_read_unit(iarchive);
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(iarchive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), expected);
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
 
     //  relaxng_FILE
 
@@ -1917,6 +2039,232 @@ int main(int, char* argv[]) {
         free(s);
     }
 
+    // parsed unit, with the document from parsing and then reparsed
+    {
+        const std::string src = "#include <a.h>\nint a = b < c && d;\n";
+
+        for (auto option : { 0u, SRCML_OPTION_POSITION }) {
+
+            char* s;
+            size_t size;
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_enable_option(archive, option);
+            srcml_archive_write_open_memory(archive, &s, &size);
+            srcml_append_transform_xpath(archive, "//src:name|//cpp:file");
+
+            srcml_unit* unit = srcml_unit_create(archive);
+            srcml_unit_set_language(unit, "C++");
+            srcml_unit_parse_memory(unit, src.c_str(), src.size());
+
+            srcml_transform_result* parsed = nullptr;
+            srcml_unit_apply_transforms(archive, unit, &parsed);
+            srcml_transform_result* reparsed = nullptr;
+            srcml_unit_apply_transforms(archive, unit, &reparsed);
+
+            dassert(srcml_transform_get_type(parsed), SRCML_RESULT_UNITS);
+            dassert(srcml_transform_get_unit_size(parsed), 6);
+            dassert(srcml_transform_get_unit_size(reparsed), 6);
+            for (int i = 0; i < 6; ++i) {
+                dassert(std::string(srcml_unit_get_srcml(srcml_transform_get_unit(parsed, i))),
+                        std::string(srcml_unit_get_srcml(srcml_transform_get_unit(reparsed, i))));
+            }
+
+            srcml_transform_free(parsed);
+            srcml_transform_free(reparsed);
+            srcml_unit_free(unit);
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+            free(s);
+        }
+    }
+
+    // bundle of independent queries on one document
+    {
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive, srcml_full.c_str(), srcml_full.size());
+        srcml_append_transform_xpath(iarchive, "//src:name");
+        srcml_append_transform_xpath_element(iarchive, "//src:name", "foo", "foo.com", "bar");
+        srcml_append_transform_xpath(iarchive, "count(//src:name)");
+        srcml_append_transform_xpath(iarchive, "boolean(//src:name)");
+        srcml_append_transform_xpath(iarchive, "string(//src:name)");
+        srcml_append_transform_xpath(iarchive, "//src:expr/src:name");
+        dassert(srcml_archive_get_transform_size(iarchive), 6);
+
+        srcml_unit* unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* results[6] = { nullptr };
+        dassert(srcml_unit_apply_transforms_bundle(iarchive, unit, results), SRCML_STATUS_OK);
+
+        dassert(srcml_transform_get_type(results[0]), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(results[0]), 1);
+        dassert(std::string(srcml_unit_get_srcml(srcml_transform_get_unit(results[0], 0))), "<s:name>b</s:name>");
+        dassert(srcml_transform_get_type(results[1]), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(results[1]), 1);
+        dassert(std::string(srcml_unit_get_srcml(srcml_transform_get_unit(results[1], 0))), R"(<s:unit xmlns:s="http://www.srcML.org/srcML/src" revision=")" SRCML_VERSION_STRING R"(" language="C++" filename="project" version="1"><s:expr_stmt><s:expr><foo:bar><s:name>b</s:name></foo:bar></s:expr>;</s:expr_stmt>
+</s:unit>)");
+        dassert(srcml_transform_get_type(results[2]), SRCML_RESULT_NUMBER);
+        dassert(srcml_transform_get_number(results[2]), 1);
+        dassert(srcml_transform_get_type(results[3]), SRCML_RESULT_BOOLEAN);
+        dassert(srcml_transform_get_bool(results[3]), 1);
+        dassert(srcml_transform_get_type(results[4]), SRCML_RESULT_STRING);
+        dassert(std::string(srcml_transform_get_string(results[4])), "b");
+        dassert(srcml_transform_get_type(results[5]), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(results[5]), 1);
+
+        for (auto result : results)
+            srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
+    // simple paths evaluated without a DOM are the same as with one
+    {
+        const std::string srcml_stream = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src" xmlns:cpp="http://www.srcML.org/srcML/cpp" revision="1.0.0" language="C++" filename="a.cpp"><cpp:include>#<cpp:directive>include</cpp:directive> <cpp:file>&lt;a.h&gt;</cpp:file></cpp:include>
+<expr_stmt><expr><literal type="string">"a &amp; b"</literal> <operator>+</operator> <name foo="x&amp;y&quot;z">b</name> <operator>+</operator> <name type="é&amp;😀">é</name></expr>;</expr_stmt><empty_stmt/>
+<comment type="block">/* c */</comment>
+</unit>
+)";
+
+        // the same query in and out of the streaming subset
+        const std::vector<std::pair<std::string, std::string>> queries = {
+            { "//src:name", "//src:name[true()]" },
+            { "//cpp:*", "//cpp:*[true()]" },
+            { "/src:unit/src:expr_stmt//src:name", "/src:unit/src:expr_stmt//src:name[true()]" },
+            { "//src:literal[@type='string']", "//src:literal[@type='string'][true()]" },
+            { "//*[@foo='x&y\"z']", "//*[@foo='x&y\"z'][true()]" },
+            { "//src:empty_stmt", "//src:empty_stmt[true()]" },
+            { "//src:comment", "//src:comment[true()]" },
+            { "//src:unit", "//src:unit[true()]" },
+            { "//src:none", "//src:none[true()]" },
+            { "count(//src:name)", "count(//src:name[true()])" },
+            { "boolean(//cpp:file)", "boolean(//cpp:file[true()])" },
+            { "boolean(//src:none)", "boolean(//src:none[true()])" },
+        };
+        for (const auto& query : queries) {
+
+            std::vector<std::string> results;
+            for (const auto& xpath : { query.first, query.second }) {
+
+                srcml_archive* iarchive = srcml_archive_create();
+                srcml_archive_read_open_memory(iarchive, srcml_stream.c_str(), srcml_stream.size());
+                srcml_append_transform_xpath(iarchive, xpath.c_str());
+                srcml_unit* unit = srcml_archive_read_unit(iarchive);
+
+                srcml_transform_result* result = nullptr;
+                srcml_unit_apply_transforms(iarchive, unit, &result);
+
+                std::string text = std::to_string(srcml_transform_get_type(result));
+                if (srcml_transform_get_type(result) == SRCML_RESULT_NUMBER)
+                    text += std::to_string(srcml_transform_get_number(result));
+                if (srcml_transform_get_type(result) == SRCML_RESULT_BOOLEAN)
+                    text += std::to_string(srcml_transform_get_bool(result));
+                for (int i = 0; i < srcml_transform_get_unit_size(result); ++i)
+                    text += srcml_unit_get_srcml_outer(srcml_transform_get_unit(result, i));
+                results.push_back(text);
+
+                srcml_transform_free(result);
+                srcml_unit_free(unit);
+                srcml_archive_close(iarchive);
+                srcml_archive_free(iarchive);
+            }
+
+            dassert(results[0], results[1]);
+        }
+
+        // non-ASCII attribute values are character references, as in the DOM output
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive, srcml_stream.c_str(), srcml_stream.size());
+        srcml_append_transform_xpath(iarchive, "//src:name");
+        srcml_unit* unit = srcml_archive_read_unit(iarchive);
+
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(iarchive, unit, &result);
+
+        dassert(srcml_transform_get_unit_size(result), 2);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result, 1)), std::string(R"(<name type="&#xE9;&amp;&#x1F600;">é</name>)"));
+
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
+    // the XPath context of the thread is reused, without the prefixes or unification table of a previous archive
+    {
+        const std::string src_ns = R"(xmlns="http://www.srcML.org/srcML/src")";
+        const std::vector<std::tuple<std::string, std::string, int>> archives = {
+            { R"(<unit )" + src_ns + R"( xmlns:foo="http://example.org/one" xmlns:cpp="http://example.org/one" revision="1.0.0" language="C++"><foo:x><name>a</name></foo:x><foo:x><name>b</name></foo:x></unit>)",
+              "/src:unit[qli:regex-match(0, 'a')]//foo:x/src:name[qli:add-element(., 0, 1)]", 1 },
+            { R"(<unit )" + src_ns + R"( xmlns:bar="http://example.org/one" revision="1.0.0" language="C++"><bar:x><name>a</name></bar:x></unit>)",
+              "//foo:x", 0 },
+            { R"(<unit )" + src_ns + R"( xmlns:pre="http://www.srcML.org/srcML/cpp" revision="1.0.0" language="C++"><pre:include>#<pre:directive>include</pre:directive></pre:include></unit>)",
+              "//cpp:directive", 1 },
+            { R"(<unit )" + src_ns + R"( revision="1.0.0" language="C++"><expr_stmt><expr><name>b</name></expr>;</expr_stmt></unit>)",
+              "//src:name[qli:add-element(., 0, 1)]", 1 },
+            { R"(<unit )" + src_ns + R"( revision="1.0.0" language="C++"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit>)",
+              "//src:name[qli:add-element(., 0, 2)]", 0 },
+        };
+
+        for (const auto& archive_query : archives) {
+
+            const auto& srcml = std::get<0>(archive_query);
+
+            srcml_archive* iarchive = srcml_archive_create();
+            srcml_archive_read_open_memory(iarchive, srcml.c_str(), srcml.size());
+            srcml_append_transform_xpath(iarchive, std::get<1>(archive_query).c_str());
+            srcml_unit* unit = srcml_archive_read_unit(iarchive);
+
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(iarchive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), std::get<2>(archive_query));
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+            srcml_archive_close(iarchive);
+            srcml_archive_free(iarchive);
+        }
+    }
+
+    // unification of a variable with more than one order, as generated for srcQL
+    {
+        const std::string srcml = R"(<unit xmlns="http://www.srcML.org/srcML/src" revision="1.0.0" language="C++"><expr_stmt><expr><name>x</name> <operator>=</operator> <name>x</name></expr>;</expr_stmt>
+<expr_stmt><expr><name>x</name> <operator>=</operator> <name>y</name></expr>;</expr_stmt>
+<expr_stmt><expr><name>y</name> <operator>=</operator> <name>y</name></expr>;</expr_stmt>
+<expr_stmt><expr><name>y</name> <operator>=</operator> <name>x</name> <operator>=</operator> <name>y</name></expr>;</expr_stmt>
+</unit>)";
+
+        const std::vector<std::pair<std::string, int>> queries = {
+            { "//src:expr[qli:clear(0)][src:name[1][qli:add-element(., 0, 1)]][src:name[2][qli:add-element(., 0, 2)]]", 2 },
+            { "//src:expr[qli:clear(0)][src:name[1][qli:add-element(., 0, 1)]][src:name[3][qli:add-element(., 0, 2)]]", 1 },
+            { "//src:expr[qli:clear()][src:name[1][qli:add-element(., 0, 1)]][src:name[2][qli:add-element(., 1, 1)]][src:name[3][qli:add-element(., 0, 2)]]", 1 },
+            { "//src:expr[qli:clear(0)][src:name[1][qli:add-element(., 0, 1)]][src:name[2][qli:add-element(., 0, 2)]][src:name[3][qli:add-element(., 0, 3)]]", 0 },
+            // orders start at 1
+            { "//src:expr[qli:clear(0)][src:name[1][qli:add-element(., 0, 0)]]", 0 },
+            { "//src:expr[qli:clear(0)][src:name[1][qli:add-element(., 0, 1)]][src:name[2][qli:add-element(., 0, 0)]]", 0 },
+        };
+
+        for (const auto& query : queries) {
+
+            srcml_archive* iarchive = srcml_archive_create();
+            srcml_archive_read_open_memory(iarchive, srcml.c_str(), srcml.size());
+            srcml_append_transform_xpath(iarchive, query.first.c_str());
+            srcml_unit* unit = srcml_archive_read_unit(iarchive);
+
+            srcml_transform_result* result = nullptr;
+            srcml_unit_apply_transforms(iarchive, unit, &result);
+
+            dassert(srcml_transform_get_unit_size(result), query.second);
+
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+            srcml_archive_close(iarchive);
+            srcml_archive_free(iarchive);
+        }
+    }
+
     srcml_cleanup_globals();
 
     return 0;
@@ -12,7 +12,9 @@
 
 #include <dassert.hpp>
 
+#include <fstream>
 #include <string.h>
+#include <vector>
 
 int main(int, char* argv[]) {
 
@@ -615,6 +617,90 @@ int main(int, char* argv[]) {
         srcml_archive_free(archive);
     }
 
+    /*
+      srcml_archive_parse_batch
+    */
+
+    std::ofstream src_file_a("a.cpp");
+    src_file_a << "a;\n";
+    src_file_a.close();
+
+    std::ofstream src_file_b("b.cpp");
+    src_file_b << "b;\n";
+    src_file_b.close();
+
+    const std::string srcml_batch = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src" revision=")" SRCML_VERSION_STRING R"(">
+
+<unit revision=")" SRCML_VERSION_STRING R"(" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>
+
+<unit revision=")" SRCML_VERSION_STRING R"(" language="C++" filename="b.cpp"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+</unit>
+
+<unit revision=")" SRCML_VERSION_STRING R"(" language="C++" filename="a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>
+
+</unit>
+)";
+
+    {
+        const char* filenames[] = { "a.cpp", "b.cpp", "missing.cpp", "a.cpp" };
+        std::vector<int> statuses;
+
+        char* s = 0;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_disable_hash(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+
+        dassert(srcml_archive_parse_batch(archive, filenames, 4, 2, &statuses, [](void* context, size_t pos, int status, srcml_unit* unit) {
+            std::vector<int>& statuses = *(std::vector<int>*) context;
+            if (pos == statuses.size() && (status == SRCML_STATUS_OK) == (unit != 0))
+                statuses.push_back(status);
+        }), SRCML_STATUS_IO_ERROR);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        dassert(statuses.size(), (size_t) 4);
+        dassert(statuses[0], SRCML_STATUS_OK);
+        dassert(statuses[1], SRCML_STATUS_OK);
+        dassert(statuses[2], SRCML_STATUS_IO_ERROR);
+        dassert(statuses[3], SRCML_STATUS_OK);
+        dassert(std::string(s, size), srcml_batch);
+
+        free(s);
+    }
+
+    {
+        const char* filenames[] = { "a.cpp" };
+
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_parse_batch(archive, filenames, 1, 2, 0, 0), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_archive_free(archive);
+    }
+
+    {
+        const char* filenames[] = { "a.cpp" };
+
+        char* s = 0;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_write_open_memory(archive, &s, &size);
+        dassert(srcml_archive_parse_batch(archive, filenames, 1, 0, 0, 0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_parse_batch(archive, 0, 1, 2, 0, 0), SRCML_STATUS_INVALID_ARGUMENT);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        free(s);
+    }
+
+    {
+        const char* filenames[] = { "a.cpp" };
+
+        dassert(srcml_archive_parse_batch(0, filenames, 1, 2, 0, 0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
     srcml_cleanup_globals();
 
     return 0;
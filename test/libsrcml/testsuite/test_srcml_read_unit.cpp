@@ -13,6 +13,12 @@
 #include <fstream>
 #include <fcntl.h>
 
+#if defined(__GNUC__) && !defined(__MINGW32__)
+#include <utime.h>
+#else
+#include <sys/utime.h>
+#endif
+
 #include <dassert.hpp>
 
 int main(int, char* argv[]) {
@@ -352,6 +358,440 @@ int main(int, char* argv[]) {
         dassert(srcml_archive_read_unit(0), 0);
     }
 
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        dassert(srcml_archive_skip_unit(archive), 1);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        const std::string srcml_empty_unit = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src">
+
+<unit language="C" filename="empty.c"/>
+
+<unit xmlns:cpp="http://www.srcML.org/srcML/cpp" language="C" filename="project.c"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+</unit>
+
+</unit>
+)";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_empty_unit.c_str(), srcml_empty_unit.size());
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("empty.c"));
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    // units that span many parser chunks
+    {
+        std::string body;
+        for (int i = 0; i < 2000; ++i)
+            body += "<expr_stmt><expr><name>a" + std::to_string(i) + "</name></expr>;</expr_stmt>\n";
+
+        std::string srcml_large = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src">
+
+)";
+        for (int i = 0; i < 3; ++i)
+            srcml_large += "<unit language=\"C\" filename=\"f" + std::to_string(i) + ".c\">" + body + "</unit>\n\n";
+        srcml_large += "</unit>\n";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_large.c_str(), srcml_large.size());
+        dassert(srcml_archive_skip_unit(archive), 1);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("f1.c"));
+        dassert(srcml_unit_get_srcml_inner(unit), body);
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("f2.c"));
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    /*
+      srcml_archive_read_unit_at
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        srcml_unit* unit = srcml_archive_read_unit_at(archive, 2);
+        dassert(srcml_unit_get_language(unit), std::string("C"));
+        dassert(srcml_unit_get_filename(unit), std::string("project.c"));
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit_at(archive, 1);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_a);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit_at(archive, 3), 0);
+        dassert(srcml_archive_read_unit_at(archive, 0), 0);
+
+        // position of the sequential read is unchanged
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_a);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_single.c_str(), srcml_single.size());
+        srcml_unit* unit = srcml_archive_read_unit_at(archive, 1);
+        dassert(srcml_unit_get_language(unit), std::string("C++"));
+        dassert(srcml_unit_get_filename(unit), std::string("project"));
+        dassert(srcml_unit_get_srcml(unit), srcml_b_single);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit_at(archive, 2), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        std::ofstream srcml_file("project_two.xml");
+        srcml_file << srcml_two;
+        srcml_file.close();
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_write_index(archive), SRCML_STATUS_OK);
+        srcml_unit* unit = srcml_archive_read_unit_at(archive, 2);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // read with the sidecar index
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        unit = srcml_archive_read_unit_at(archive, 2);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // the sidecar index is not used for an archive edited to the same size
+        std::string edited = srcml_two;
+        edited.replace(edited.find("\n\n"), 2, "\n");
+        edited.replace(edited.find("<name>b<"), 8, "<name>bb<");
+        srcml_file.open("project_two.xml");
+        srcml_file << edited;
+        srcml_file.close();
+
+        std::string edited_b = srcml_b_two;
+        edited_b.replace(edited_b.find("<name>b<"), 8, "<name>bb<");
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        unit = srcml_archive_read_unit_at(archive, 2);
+        dassert(srcml_unit_get_srcml_outer(unit), edited_b);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // an archive edited to the same size and modification time is indexed again
+        // when the unit is not at the indexed position
+        struct utimbuf times = { 1000000000, 1000000000 };
+        srcml_file.open("project_two.xml");
+        srcml_file << srcml_two;
+        srcml_file.close();
+        utime("project_two.xml", &times);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_write_index(archive), SRCML_STATUS_OK);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        srcml_file.open("project_two.xml");
+        srcml_file << edited;
+        srcml_file.close();
+        utime("project_two.xml", &times);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        unit = srcml_archive_read_unit_at(archive, 2);
+        dassert(srcml_unit_get_srcml_outer(unit), edited_b);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        srcml_file.open("project_two.xml");
+        srcml_file << srcml_two;
+        srcml_file.close();
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_read_unit_at(archive, 1), 0);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_read_unit_at(0, 1), 0);
+    }
+
+    /*
+      srcml_archive_read_unit_by_filename
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_full.c_str(), srcml_full.size());
+        srcml_unit* unit = srcml_archive_read_unit_by_filename(archive, "project");
+        dassert(srcml_unit_get_language(unit), std::string("C++"));
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit_by_filename(archive, "project.c"), 0);
+        dassert(srcml_archive_read_unit_by_filename(archive, 0), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_read_unit_by_filename(0, "project"), 0);
+    }
+
+    /*
+      srcml_archive_write_index
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        dassert(srcml_archive_write_index(archive), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_write_index(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    /*
+      srcml_archive_enable_parallel_read
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        dassert(srcml_archive_enable_parallel_read(archive, 2), SRCML_STATUS_OK);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_a);
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_enable_parallel_read(archive, 2), SRCML_STATUS_OK);
+        dassert(srcml_archive_skip_unit(archive), 1);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+        srcml_unit_free(unit);
+        dassert(srcml_archive_skip_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        // enough units for many chunks, more than are parsed ahead of the reader
+        std::string srcml_many = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src">
+
+)";
+        const std::string comment(1000, 'c');
+        for (int i = 0; i < 5000; ++i) {
+            srcml_many += R"(<unit language="C" filename=")" + std::to_string(i) + R"(.c"><comment type="block">/*)" + comment + R"(*/</comment>
+</unit>
+
+)";
+        }
+        srcml_many += "</unit>\n";
+
+        for (int threads : { 1, 3 }) {
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_read_open_memory(archive, srcml_many.c_str(), srcml_many.size());
+            dassert(srcml_archive_enable_parallel_read(archive, threads), SRCML_STATUS_OK);
+            int count = 0;
+            bool ordered = true;
+            while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+                ordered = ordered && srcml_unit_get_filename(unit) == std::to_string(count) + ".c";
+                srcml_unit_free(unit);
+                ++count;
+            }
+            dassert(count, 5000);
+            dassert(ordered, true);
+            dassert(srcml_archive_error_number(archive), SRCML_STATUS_OK);
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+        }
+
+        // a chunk that cannot be parsed ends the units with an error
+        srcml_many.replace(srcml_many.find("</comment>", srcml_many.find(R"(filename="2500.c")")), 10, "</commenx>");
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_many.c_str(), srcml_many.size());
+        dassert(srcml_archive_enable_parallel_read(archive, 3), SRCML_STATUS_OK);
+        int count = 0;
+        while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+            srcml_unit_free(unit);
+            ++count;
+        }
+        dassert(count, 2500);
+        dassert(srcml_archive_error_number(archive), SRCML_STATUS_INVALID_INPUT);
+        dassert(srcml_archive_read_unit(archive), 0);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_single.c_str(), srcml_single.size());
+        dassert(srcml_archive_enable_parallel_read(archive, 2), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_srcml(unit), srcml_b_single);
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_enable_parallel_read(archive, 2), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_enable_parallel_read(0, 2), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    /*
+      srcml_archive_write_term_index
+      srcml_archive_read_term_index
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_write_term_index(archive), SRCML_STATUS_OK);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // units without the terms of the query have the empty result
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_read_term_index(archive), SRCML_STATUS_OK);
+        srcml_append_transform_xpath(archive, "//src:expr[src:name='b']");
+
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(archive, unit, &result);
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_NONE);
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        unit = srcml_archive_read_unit(archive);
+        srcml_unit_apply_transforms(archive, unit, &result);
+        dassert(srcml_transform_get_unit_size(result), 1);
+        dassert(srcml_unit_get_srcml(srcml_transform_get_unit(result, 0)), std::string("<expr><name>b</name></expr>"));
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_read_term_index(archive), SRCML_STATUS_OK);
+        srcml_append_transform_xpath(archive, "count(//src:name[.='b'])");
+
+        unit = srcml_archive_read_unit(archive);
+        srcml_unit_apply_transforms(archive, unit, &result);
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_NUMBER);
+        dassert(srcml_transform_get_number(result), 0);
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        unit = srcml_archive_read_unit(archive);
+        srcml_unit_apply_transforms(archive, unit, &result);
+        dassert(srcml_transform_get_number(result), 1);
+        srcml_transform_free(result);
+        srcml_unit_free(unit);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // the attributes of the unit start tag are terms
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_read_term_index(archive), SRCML_STATUS_OK);
+        srcml_append_transform_xpath(archive, "count(/src:unit[@language='C'][@filename='project.c']//src:name)");
+
+        for (int i = 0; i < 2; ++i) {
+            unit = srcml_archive_read_unit(archive);
+            srcml_unit_apply_transforms(archive, unit, &result);
+            dassert(srcml_transform_get_number(result), 1);
+            srcml_transform_free(result);
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // the term index is not used for an archive edited to the same size
+        std::string edited = srcml_two;
+        edited.replace(edited.find("<name>a<"), 8, "<name>b<");
+        std::ofstream srcml_file("project_two.xml");
+        srcml_file << edited;
+        srcml_file.close();
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "project_two.xml");
+        dassert(srcml_archive_read_term_index(archive), SRCML_STATUS_IO_ERROR);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        srcml_file.open("project_two.xml");
+        srcml_file << srcml_two;
+        srcml_file.close();
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        dassert(srcml_archive_write_term_index(archive), SRCML_STATUS_INVALID_IO_OPERATION);
+        dassert(srcml_archive_read_term_index(archive), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_write_term_index(0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_read_term_index(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
     srcml_cleanup_globals();
 
     return 0;
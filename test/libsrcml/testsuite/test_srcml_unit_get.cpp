@@ -367,6 +367,80 @@ int main(int, char* argv[]) {
         dassert(srcml_unit_get_srcml_outer(0), 0);
     }
 
+    /*
+      srcml_unit_get_srcml_outer_view
+    */
+
+    {
+        srcml_unit* unit = srcml_unit_create(archive);
+        const char* data[3];
+        size_t sizes[3];
+        int count = 0;
+
+        dassert(srcml_unit_get_srcml_outer_view(unit, data, sizes, &count), SRCML_STATUS_UNINITIALIZED_UNIT);
+
+        srcml_unit_free(unit);
+    }
+
+    {
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C++");
+        srcml_unit_parse_memory(unit, "a;", 2);
+        const char* data[3];
+        size_t sizes[3];
+        int count = 0;
+
+        dassert(srcml_unit_get_srcml_outer_view(unit, data, sizes, &count), SRCML_STATUS_OK);
+        std::string outer;
+        for (int i = 0; i < count; ++i)
+            outer.append(data[i], sizes[i]);
+        dassert(outer, std::string(srcml_unit_get_srcml_outer(unit)));
+
+        srcml_unit_free(unit);
+    }
+
+    {
+        const char* data[3];
+        size_t sizes[3];
+        int count = 0;
+
+        dassert(srcml_unit_get_srcml_outer_view(0, data, sizes, &count), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    /*
+      srcml_unit_get_srcml_inner_view
+    */
+
+    {
+        srcml_unit* unit = srcml_unit_create(archive);
+        const char* data = 0;
+        size_t size = 0;
+
+        dassert(srcml_unit_get_srcml_inner_view(unit, &data, &size), SRCML_STATUS_UNINITIALIZED_UNIT);
+
+        srcml_unit_free(unit);
+    }
+
+    {
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C++");
+        srcml_unit_parse_memory(unit, "a;", 2);
+        const char* data = 0;
+        size_t size = 0;
+
+        dassert(srcml_unit_get_srcml_inner_view(unit, &data, &size), SRCML_STATUS_OK);
+        dassert(std::string(data, size), std::string("<expr_stmt><expr><name>a</name></expr>;</expr_stmt>"));
+
+        srcml_unit_free(unit);
+    }
+
+    {
+        const char* data = 0;
+        size_t size = 0;
+
+        dassert(srcml_unit_get_srcml_inner_view(0, &data, &size), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
     /*
       srcml_unit_get_srcml
     */
@@ -388,6 +462,46 @@ int main(int, char* argv[]) {
         srcml_unit_free(unit);
     }
 
+    /*
+      srcdiff revisions
+    */
+    {
+        const std::string srcdiff = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src" xmlns:diff="http://www.srcML.org/srcDiff" revision="1.0.0" language="C++" filename="a.cpp|b.cpp"><expr_stmt><expr><diff:delete type="replace"><name>a</name></diff:delete><diff:insert type="replace"><name>b</name></diff:insert></expr>;</expr_stmt><diff:insert><empty_stmt/></diff:insert></unit>
+)";
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive, srcdiff.c_str(), srcdiff.size());
+        srcml_archive_set_srcdiff_revision(iarchive, SRCDIFF_REVISION_ORIGINAL);
+        srcml_unit* unit = srcml_archive_read_unit(iarchive);
+
+        dassert(srcml_unit_get_srcml_inner(unit), std::string("<expr_stmt><expr><name>a</name></expr>;</expr_stmt>"));
+        dassert(srcml_unit_get_srcml_outer(unit), std::string(R"(<unit xmlns:diff="http://www.srcML.org/srcDiff" revision="1.0.0" language="C++" filename="a.cpp|b.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit>)"));
+
+        // each revision in turn from the same unit
+        srcml_archive_set_srcdiff_revision(iarchive, SRCDIFF_REVISION_MODIFIED);
+        dassert(srcml_unit_get_srcml_inner(unit), std::string("<expr_stmt><expr><name>b</name></expr>;</expr_stmt><empty_stmt/>"));
+        dassert(srcml_unit_get_srcml_outer(unit), std::string(R"(<unit xmlns:diff="http://www.srcML.org/srcDiff" revision="1.0.0" language="C++" filename="a.cpp|b.cpp"><expr_stmt><expr><name>b</name></expr>;</expr_stmt><empty_stmt/></unit>)"));
+
+        srcml_archive_set_srcdiff_revision(iarchive, SRCDIFF_REVISION_ORIGINAL);
+        dassert(srcml_unit_get_srcml_inner(unit), std::string("<expr_stmt><expr><name>a</name></expr>;</expr_stmt>"));
+
+        // srcml written to the unit replaces the revisions of the previous srcml
+        srcml_write_start_unit(unit);
+        srcml_write_start_element(unit, 0, "element", 0);
+        srcml_write_string(unit, "c");
+        srcml_write_end_element(unit);
+        srcml_write_end_unit(unit);
+
+        dassert(srcml_unit_get_srcml_inner(unit), std::string("<element>c</element>"));
+        srcml_archive_set_srcdiff_revision(iarchive, SRCDIFF_REVISION_MODIFIED);
+        dassert(srcml_unit_get_srcml_inner(unit), std::string("<element>c</element>"));
+
+        srcml_unit_free(unit);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
     srcml_archive_free(archive);
 
     srcml_cleanup_globals();
@@ -141,6 +141,35 @@ int main(int, char* argv[]) {
         dassert(srcml_write_end_unit(0), SRCML_STATUS_INVALID_ARGUMENT);
     }
 
+    {
+        char* s = 0;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_solitary_unit(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C++");
+        srcml_write_start_unit(unit);
+        srcml_write_start_element(unit, 0, "element", 0);
+        srcml_write_string(unit, "a");
+        srcml_write_end_element(unit);
+        srcml_write_end_unit(unit);
+
+        dassert(std::string(srcml_unit_get_srcml(unit)), R"(<unit xmlns="http://www.srcML.org/srcML/src" revision=")" SRCML_VERSION_STRING R"(" language="C++"><element>a</element></unit>)");
+
+        srcml_write_start_unit(unit);
+        srcml_write_start_element(unit, 0, "element", 0);
+        srcml_write_end_element(unit);
+        srcml_write_end_unit(unit);
+
+        dassert(std::string(srcml_unit_get_srcml(unit)), R"(<unit xmlns="http://www.srcML.org/srcML/src" revision=")" SRCML_VERSION_STRING R"(" language="C++"><element/></unit>)");
+
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        free(s);
+    }
+
     /*
         srcml_write_start_element
     */
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <utility>
 
 #if defined(__GNUC__) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -3455,6 +3456,42 @@ const std::string int_x_in_big_if_srcml =
         srcml_archive_free(iarchive);
     }
 
+    // if (true) { int z; }
+    {
+        char* s;
+        size_t size;
+
+        srcml_archive* oarchive = srcml_archive_create();
+        srcml_archive_write_open_memory(oarchive,&s, &size);
+
+        srcml_unit* unit = srcml_unit_create(oarchive);
+        srcml_unit_set_language(unit,"C++");
+        srcml_unit_parse_memory(unit,int_x_in_ifs.c_str(),int_x_in_ifs.size());
+        dassert(srcml_archive_write_unit(oarchive,unit), SRCML_STATUS_OK);
+
+        srcml_unit_free(unit);
+        srcml_archive_close(oarchive);
+        srcml_archive_free(oarchive);
+
+        std::string srcml_text = std::string(s, size);
+        free(s);
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive,srcml_text.c_str(),srcml_text.size());
+        dassert(srcml_append_transform_srcql(iarchive,"if (true) { int z; }"), SRCML_STATUS_OK);
+
+        unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(iarchive, unit, &result);
+
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_NONE);
+
+        srcml_unit_free(unit);
+        srcml_transform_free(result);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
     // if () { if() {} }
     {
         char* s;
@@ -5019,6 +5056,93 @@ int func9(int x) {
         srcml_archive_free(iarchive);
     }
 
+    // FIND $A + $B + $A;
+    {
+        char* s;
+        size_t size;
+
+        srcml_archive* oarchive = srcml_archive_create();
+        srcml_archive_write_open_memory(oarchive,&s, &size);
+
+        srcml_unit* unit = srcml_unit_create(oarchive);
+        srcml_unit_set_language(unit,"C++");
+        srcml_unit_parse_memory(unit,list_of_exprs.c_str(),list_of_exprs.size());
+        dassert(srcml_archive_write_unit(oarchive,unit), SRCML_STATUS_OK);
+
+        srcml_unit_free(unit);
+        srcml_archive_close(oarchive);
+        srcml_archive_free(oarchive);
+
+        std::string srcml_text = std::string(s, size);
+        free(s);
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive,srcml_text.c_str(),srcml_text.size());
+        dassert(srcml_append_transform_srcql(iarchive,"FIND $A + $B + $A;"), SRCML_STATUS_OK);
+
+        unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(iarchive, unit, &result);
+
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(result), 9);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,0)), expr_stmts_srcml[17]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,1)), expr_stmts_srcml[20]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,2)), expr_stmts_srcml[23]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,3)), expr_stmts_srcml[27]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,4)), expr_stmts_srcml[30]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,5)), expr_stmts_srcml[33]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,6)), expr_stmts_srcml[37]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,7)), expr_stmts_srcml[40]);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,8)), expr_stmts_srcml[43]);
+
+        srcml_unit_free(unit);
+        srcml_transform_free(result);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
+    // FIND $X = $X;
+    {
+        const std::string assignments_src = "x = x;\nx = y;\ny = y;\n";
+
+        char* s;
+        size_t size;
+
+        srcml_archive* oarchive = srcml_archive_create();
+        srcml_archive_write_open_memory(oarchive,&s, &size);
+
+        srcml_unit* unit = srcml_unit_create(oarchive);
+        srcml_unit_set_language(unit,"C++");
+        srcml_unit_parse_memory(unit,assignments_src.c_str(),assignments_src.size());
+        dassert(srcml_archive_write_unit(oarchive,unit), SRCML_STATUS_OK);
+
+        srcml_unit_free(unit);
+        srcml_archive_close(oarchive);
+        srcml_archive_free(oarchive);
+
+        std::string srcml_text = std::string(s, size);
+        free(s);
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive,srcml_text.c_str(),srcml_text.size());
+        dassert(srcml_append_transform_srcql(iarchive,"FIND $X = $X;"), SRCML_STATUS_OK);
+
+        unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* result = nullptr;
+        srcml_unit_apply_transforms(iarchive, unit, &result);
+
+        dassert(srcml_transform_get_type(result), SRCML_RESULT_UNITS);
+        dassert(srcml_transform_get_unit_size(result), 2);
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,0)), std::string(R"(<expr_stmt><expr><name>x</name> <operator>=</operator> <name>x</name></expr>;</expr_stmt>)"));
+        dassert(srcml_unit_get_srcml_inner(srcml_transform_get_unit(result,1)), std::string(R"(<expr_stmt><expr><name>y</name> <operator>=</operator> <name>y</name></expr>;</expr_stmt>)"));
+
+        srcml_unit_free(unit);
+        srcml_transform_free(result);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
     // FIND $CALL()
     {
         char* s;
@@ -9436,6 +9560,59 @@ int PascalCase() { call(); }
     }
 
 
+    // MATCH patterns that are a literal, or a literal with a leading and/or trailing .*,
+    // must match the same tokens as the regex, where . does not match a line terminator
+    const std::string match_forms_src = "foo;\nfoobar;\nbarfoo;\na +\n    foo;\n";
+
+    const std::vector<std::pair<std::string, int>> match_forms {
+        { "foo",           1 },
+        { "^foo$",         1 },
+        { "foo.*",         2 },
+        { ".*foo",         2 },
+        { ".*foo.*",       3 },
+        { ".*",            3 },
+        { "foo\\$",        0 },
+        { "[\\s\\S]*foo",  3 },
+        { "foo(",          0 },
+    };
+
+    for (const auto& form : match_forms) {
+        char* s;
+        size_t size;
+        srcml_archive* oarchive = srcml_archive_create();
+        srcml_archive_write_open_memory(oarchive,&s, &size);
+
+        srcml_unit* unit = srcml_unit_create(oarchive);
+        srcml_unit_set_language(unit,"C++");
+        srcml_unit_parse_memory(unit,match_forms_src.c_str(),match_forms_src.size());
+        dassert(srcml_archive_write_unit(oarchive,unit), SRCML_STATUS_OK);
+
+        srcml_unit_free(unit);
+        srcml_archive_close(oarchive);
+        srcml_archive_free(oarchive);
+
+        std::string srcml_text = std::string(s, size);
+        free(s);
+
+        const std::string query = "FIND $X; WHERE MATCH($X,\"" + form.first + "\")";
+
+        srcml_archive* iarchive = srcml_archive_create();
+        srcml_archive_read_open_memory(iarchive,srcml_text.c_str(),srcml_text.size());
+        dassert(srcml_append_transform_srcql(iarchive,query.c_str()), SRCML_STATUS_OK);
+
+        unit = srcml_archive_read_unit(iarchive);
+        srcml_transform_result* result = nullptr;
+        dassert(srcml_unit_apply_transforms(iarchive, unit, &result), SRCML_STATUS_OK);
+
+        dassert(srcml_transform_get_unit_size(result), form.second);
+
+        srcml_unit_free(unit);
+        srcml_transform_free(result);
+        srcml_archive_close(iarchive);
+        srcml_archive_free(iarchive);
+    }
+
+
     //// NOT
     // FIND $TYPE $NAME() {} WHERE NOT(int $NAME() {})
     {